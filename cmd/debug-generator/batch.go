@@ -0,0 +1,337 @@
+package main
+
+import (
+	"bufio"
+	"bytes"
+	"crypto/sha256"
+	"encoding/hex"
+	"encoding/json"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"sync"
+	"text/tabwriter"
+	"time"
+
+	"github.com/docker/docker/api/types/container"
+	"github.com/docker/go-connections/nat"
+
+	"watchcow/internal/fpkgen"
+)
+
+// batchJob is one package to generate in batch mode
+type batchJob struct {
+	source string // Where the config came from, e.g. "line 3" or "service web"
+	config *fpkgen.AppConfig
+}
+
+// batchResult is the outcome of one batchJob
+type batchResult struct {
+	dir      string
+	duration time.Duration
+	err      error
+}
+
+// runBatch generates every config listed in path ("-" for stdin) under
+// outputDir/<appname>, sharing one generator across workers. Returns the exit code.
+func runBatch(generator *fpkgen.Generator, path, outputDir string, workers int) int {
+	var r io.Reader = os.Stdin
+	if path != "-" {
+		f, err := os.Open(path)
+		if err != nil {
+			fmt.Fprintf(os.Stderr, "Failed to open batch file: %v\n", err)
+			return 1
+		}
+		defer f.Close()
+		r = f
+	}
+
+	jobs, err := readBatch(generator, r)
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "Failed to read batch file: %v\n", err)
+		return 1
+	}
+	if len(jobs) == 0 {
+		fmt.Fprintln(os.Stderr, "Batch file lists no apps")
+		return 1
+	}
+
+	// Packages land in outputDir/<appname>, so app names must be unique
+	seen := make(map[string]string, len(jobs))
+	for _, job := range jobs {
+		if prev, ok := seen[job.config.AppName]; ok {
+			fmt.Fprintf(os.Stderr, "Duplicate appname %s (%s and %s)\n", job.config.AppName, prev, job.source)
+			return 1
+		}
+		seen[job.config.AppName] = job.source
+	}
+
+	if err := os.MkdirAll(outputDir, 0755); err != nil {
+		fmt.Fprintf(os.Stderr, "Failed to create output directory: %v\n", err)
+		return 1
+	}
+
+	if workers < 1 {
+		workers = 1
+	}
+	results := make([]batchResult, len(jobs))
+	indexes := make(chan int)
+	var wg sync.WaitGroup
+	start := time.Now()
+
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := range indexes {
+				dir := filepath.Join(outputDir, jobs[i].config.AppName)
+				t := time.Now()
+				err := generator.GenerateFromConfig(jobs[i].config, dir)
+				results[i] = batchResult{dir: dir, duration: time.Since(t), err: err}
+			}
+		}()
+	}
+	for i := range jobs {
+		indexes <- i
+	}
+	close(indexes)
+	wg.Wait()
+
+	return printBatchReport(os.Stdout, jobs, results, time.Since(start), workers)
+}
+
+// printBatchReport prints per-package timings in input order and returns the exit code
+func printBatchReport(w io.Writer, jobs []batchJob, results []batchResult, wall time.Duration, workers int) int {
+	tw := tabwriter.NewWriter(w, 0, 0, 2, ' ', 0)
+	fmt.Fprintln(tw, "APP\tSOURCE\tTIME\tRESULT")
+
+	var sum time.Duration
+	failed := 0
+	for i, job := range jobs {
+		res := results[i]
+		sum += res.duration
+		status := res.dir
+		if res.err != nil {
+			status = "FAILED: " + res.err.Error()
+			failed++
+		}
+		fmt.Fprintf(tw, "%s\t%s\t%s\t%s\n", job.config.AppName, job.source,
+			res.duration.Round(time.Microsecond), status)
+	}
+	tw.Flush()
+
+	fmt.Fprintf(w, "\n%d packages (%d failed) in %s with %d workers (sum %s)\n",
+		len(jobs), failed, wall.Round(time.Millisecond), workers, sum.Round(time.Millisecond))
+	if failed > 0 {
+		return 1
+	}
+	return 0
+}
+
+// readBatch parses a batch file: either `docker compose config --format json`
+// output, or JSON lines where each object holds the single-mode keys
+func readBatch(generator *fpkgen.Generator, r io.Reader) ([]batchJob, error) {
+	data, err := io.ReadAll(r)
+	if err != nil {
+		return nil, err
+	}
+
+	var compose composeFile
+	if json.Unmarshal(data, &compose) == nil && compose.Services != nil {
+		return composeJobs(generator, &compose), nil
+	}
+	return jsonLineJobs(generator, data)
+}
+
+// jsonLineJobs builds one job per non-empty, non-comment line. A line with a
+// "labels" object is treated like a container carrying those labels; any other
+// line overrides the single-mode defaults with its keys.
+func jsonLineJobs(generator *fpkgen.Generator, data []byte) ([]batchJob, error) {
+	var jobs []batchJob
+	scanner := bufio.NewScanner(bytes.NewReader(data))
+	scanner.Buffer(make([]byte, 0, 64*1024), 4*1024*1024)
+
+	for n := 1; scanner.Scan(); n++ {
+		line := bytes.TrimSpace(scanner.Bytes())
+		if len(line) == 0 || line[0] == '#' {
+			continue
+		}
+
+		var fields map[string]json.RawMessage
+		if err := json.Unmarshal(line, &fields); err != nil {
+			return nil, fmt.Errorf("line %d: %w", n, err)
+		}
+		source := fmt.Sprintf("line %d", n)
+
+		values := make(map[string]string, len(fields))
+		for key, raw := range fields {
+			if key == "labels" {
+				continue
+			}
+			values[key] = rawString(raw)
+		}
+
+		var config *fpkgen.AppConfig
+		if raw, ok := fields["labels"]; ok {
+			var labels composeMap
+			if err := json.Unmarshal(raw, &labels); err != nil {
+				return nil, fmt.Errorf("line %d: labels: %w", n, err)
+			}
+			name := values["container_name"]
+			if name == "" {
+				name = fmt.Sprintf("batch-%d", n)
+			}
+			config = labelConfig(generator, name, values["image"], labels.strings(), values["service_port"], nil, "")
+		} else {
+			config = defaultConfig()
+			// Sorted so repeated "Unknown key" warnings come out in a stable order
+			keys := make([]string, 0, len(values))
+			for key := range values {
+				keys = append(keys, key)
+			}
+			sort.Strings(keys)
+			for _, key := range keys {
+				applyConfig(config, key, values[key])
+			}
+		}
+		jobs = append(jobs, batchJob{source: source, config: config})
+	}
+	if err := scanner.Err(); err != nil {
+		return nil, err
+	}
+	return jobs, nil
+}
+
+// rawString returns a JSON string unquoted, or any other value as written (e.g. 8080)
+func rawString(raw json.RawMessage) string {
+	var s string
+	if json.Unmarshal(raw, &s) == nil {
+		return s
+	}
+	return string(bytes.TrimSpace(raw))
+}
+
+// composeFile is the subset of `docker compose config --format json` used here
+type composeFile struct {
+	Services map[string]composeService `json:"services"`
+}
+
+type composeService struct {
+	Image         string        `json:"image"`
+	ContainerName string        `json:"container_name"`
+	Labels        composeMap    `json:"labels"`
+	Environment   composeMap    `json:"environment"`
+	Ports         []composePort `json:"ports"`
+	Restart       string        `json:"restart"`
+}
+
+type composePort struct {
+	Target    json.Number `json:"target"`
+	Published json.Number `json:"published"`
+}
+
+// composeMap accepts both compose forms: {"k": "v"} and ["k=v"].
+// A nil value (a key without "=") is kept as nil.
+type composeMap map[string]*string
+
+func (m *composeMap) UnmarshalJSON(data []byte) error {
+	var list []string
+	if json.Unmarshal(data, &list) == nil {
+		*m = make(composeMap, len(list))
+		for _, item := range list {
+			if key, value, ok := strings.Cut(item, "="); ok {
+				(*m)[key] = &value
+			} else {
+				(*m)[item] = nil
+			}
+		}
+		return nil
+	}
+	var values map[string]*string
+	if err := json.Unmarshal(data, &values); err != nil {
+		return err
+	}
+	*m = values
+	return nil
+}
+
+// strings returns the map with nil values as empty strings
+func (m composeMap) strings() map[string]string {
+	out := make(map[string]string, len(m))
+	for key, value := range m {
+		if value != nil {
+			out[key] = *value
+		} else {
+			out[key] = ""
+		}
+	}
+	return out
+}
+
+// env returns the map as KEY=value entries, skipping keys without a value
+func (m composeMap) env() []string {
+	var out []string
+	for key, value := range m {
+		if value != nil {
+			out = append(out, key+"="+*value)
+		}
+	}
+	sort.Strings(out)
+	return out
+}
+
+// composeJobs builds one job per service, in service name order
+func composeJobs(generator *fpkgen.Generator, compose *composeFile) []batchJob {
+	names := make([]string, 0, len(compose.Services))
+	for name := range compose.Services {
+		names = append(names, name)
+	}
+	sort.Strings(names)
+
+	jobs := make([]batchJob, 0, len(names))
+	for _, name := range names {
+		svc := compose.Services[name]
+		containerName := svc.ContainerName
+		if containerName == "" {
+			containerName = name
+		}
+		port := ""
+		for _, p := range svc.Ports {
+			if p.Published != "" {
+				port = string(p.Published)
+				break
+			}
+		}
+		config := labelConfig(generator, containerName, svc.Image, svc.Labels.strings(), port, svc.Environment.env(), svc.Restart)
+		jobs = append(jobs, batchJob{source: "service " + name, config: config})
+	}
+	return jobs
+}
+
+// labelConfig builds the config the monitor would generate for a container
+// with these properties, via a synthetic inspect result
+func labelConfig(generator *fpkgen.Generator, name, image string, labels map[string]string, hostPort string, env []string, restart string) *fpkgen.AppConfig {
+	// Stable fake ID so repeated runs produce identical packages
+	sum := sha256.Sum256([]byte(name))
+
+	hostConfig := &container.HostConfig{RestartPolicy: container.RestartPolicy{Name: container.RestartPolicyMode(restart)}}
+	if hostPort != "" {
+		hostConfig.PortBindings = nat.PortMap{nat.Port(hostPort + "/tcp"): {{HostPort: hostPort}}}
+	}
+
+	return generator.ConfigFromInspect(&container.InspectResponse{
+		ContainerJSONBase: &container.ContainerJSONBase{
+			ID:         hex.EncodeToString(sum[:]),
+			Name:       "/" + name,
+			HostConfig: hostConfig,
+		},
+		Config: &container.Config{
+			Image:  image,
+			Labels: labels,
+			Env:    env,
+		},
+	})
+}
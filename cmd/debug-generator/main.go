@@ -5,6 +5,7 @@ import (
 	"fmt"
 	"log/slog"
 	"os"
+	"runtime"
 	"strings"
 
 	"watchcow/internal/fpkgen"
@@ -13,39 +14,36 @@ import (
 func main() {
 	// Flags
 	outputDir := flag.String("output", "./debug-output", "Output directory for generated app")
+	iconCacheDir := flag.String("icon-cache", "", "Directory for persistent icon cache (disabled if empty)")
+	batchFile := flag.String("batch", "", "Generate every app listed in this file (JSON lines or compose JSON, - for stdin)")
+	workers := flag.Int("workers", runtime.NumCPU(), "Concurrent package generations in batch mode")
 	flag.Parse()
 
-	// Configure logging
-	handler := slog.NewTextHandler(os.Stdout, &slog.HandlerOptions{Level: slog.LevelDebug})
+	// Configure logging; batch mode only logs problems so the report stays readable
+	level := slog.LevelDebug
+	if *batchFile != "" {
+		level = slog.LevelWarn
+	}
+	handler := slog.NewTextHandler(os.Stdout, &slog.HandlerOptions{Level: level})
 	slog.SetDefault(slog.New(handler))
 
 	// Parse key=value arguments
 	args := flag.Args()
-	if len(args) == 0 {
+	if len(args) == 0 && *batchFile == "" {
 		printUsage()
 		os.Exit(1)
 	}
 
-	// Build config from arguments
-	config := &fpkgen.AppConfig{
-		// Defaults
-		AppName:       "debug.test-app",
-		Version:       "1.0.0",
-		DisplayName:   "Test App",
-		Description:   "Debug generated app",
-		Maintainer:    "WatchCow Debug",
-		ContainerID:   "debug123456",
-		ContainerName: "debug-container",
-		Image:         "nginx:latest",
-		Protocol:      "http",
-		Port:          "8080",
-		Path:          "/",
-		UIType:        "url",
-		Icon:          "",
-		RestartPolicy: "unless-stopped",
-		Labels:        make(map[string]string),
+	if *batchFile != "" {
+		generator := newGenerator(*iconCacheDir)
+		code := runBatch(generator, *batchFile, *outputDir, *workers)
+		generator.Close()
+		os.Exit(code)
 	}
 
+	// Build config from arguments
+	config := defaultConfig()
+
 	// Override with provided key=value pairs
 	for _, arg := range args {
 		parts := strings.SplitN(arg, "=", 2)
@@ -74,11 +72,7 @@ func main() {
 	fmt.Println()
 
 	// Create generator (uses template engine internally)
-	generator, err := fpkgen.NewGenerator()
-	if err != nil {
-		slog.Error("Failed to create generator", "error", err)
-		os.Exit(1)
-	}
+	generator := newGenerator(*iconCacheDir)
 	defer generator.Close()
 
 	// Ensure output directory exists
@@ -99,14 +93,59 @@ func main() {
 	fmt.Printf("Output directory: %s\n", *outputDir)
 }
 
+// defaultConfig returns the config that key=value pairs are applied on top of
+func defaultConfig() *fpkgen.AppConfig {
+	return &fpkgen.AppConfig{
+		AppName:       "debug.test-app",
+		Version:       "1.0.0",
+		DisplayName:   "Test App",
+		Description:   "Debug generated app",
+		Maintainer:    "WatchCow Debug",
+		ContainerID:   "debug123456",
+		ContainerName: "debug-container",
+		Image:         "nginx:latest",
+		Protocol:      "http",
+		Port:          "8080",
+		Path:          "/",
+		UIType:        "url",
+		Icon:          "",
+		RestartPolicy: "unless-stopped",
+		Labels:        make(map[string]string),
+	}
+}
+
+// newGenerator creates the generator, with a persistent icon cache if iconCacheDir is set
+func newGenerator(iconCacheDir string) *fpkgen.Generator {
+	var genOpts []fpkgen.GeneratorOption
+	if iconCacheDir != "" {
+		iconCache, err := fpkgen.NewIconCache(iconCacheDir, fpkgen.DefaultIconCacheTTL)
+		if err != nil {
+			slog.Error("Failed to open icon cache", "error", err)
+			os.Exit(1)
+		}
+		genOpts = append(genOpts, fpkgen.WithIconCache(iconCache))
+	}
+
+	generator, err := fpkgen.NewGenerator(genOpts...)
+	if err != nil {
+		slog.Error("Failed to create generator", "error", err)
+		os.Exit(1)
+	}
+	return generator
+}
+
 func printUsage() {
 	fmt.Println("Debug Generator - Generate fnOS app directory from key=value pairs")
 	fmt.Println()
 	fmt.Println("Usage:")
 	fmt.Println("  debug-generator [flags] key=value [key=value ...]")
+	fmt.Println("  debug-generator -batch apps.jsonl [-workers N] [-output dir]")
 	fmt.Println()
 	fmt.Println("Flags:")
 	fmt.Println("  -output string   Output directory (default \"./debug-output\")")
+	fmt.Println("  -icon-cache dir  Persistent icon cache directory (default: disabled)")
+	fmt.Println("  -batch file      Generate many apps into <output>/<appname> (- for stdin)")
+	fmt.Println("  -workers int     Concurrent generations in batch mode (default: CPU count)")
 	fmt.Println()
 	fmt.Println("Supported keys (following fnOS manifest conventions):")
 	fmt.Println("  appname        - App identifier (e.g., watchcow.myapp)")
@@ -124,6 +163,13 @@ func printUsage() {
 	fmt.Println()
 	fmt.Println("Example:")
 	fmt.Println("  debug-generator appname=watchcow.nginx display_name=\"Nginx Server\" service_port=80")
+	fmt.Println()
+	fmt.Println("Batch file formats:")
+	fmt.Println("  JSON lines, one app per line using the keys above:")
+	fmt.Println("    {\"appname\": \"watchcow.nginx\", \"service_port\": 80}")
+	fmt.Println("  or with container labels, generated as the monitor would:")
+	fmt.Println("    {\"container_name\": \"web\", \"image\": \"nginx\", \"labels\": {\"watchcow.enable\": \"true\"}}")
+	fmt.Println("  Compose services: docker compose config --format json | debug-generator -batch -")
 }
 
 func applyConfig(config *fpkgen.AppConfig, key, value string) {
@@ -7,13 +7,32 @@ import (
 	"os"
 	"os/signal"
 	"syscall"
+	"time"
 
 	"watchcow/internal/docker"
+	"watchcow/internal/fpkgen"
+	"watchcow/internal/trace"
 )
 
 func main() {
 	// Parse command line flags
 	debug := flag.Bool("debug", false, "Enable debug mode")
+	dataDir := flag.String("data-dir", os.Getenv("TRIM_PKGVAR"), "Directory for persistent data such as the icon cache (empty disables)")
+	iconConcurrency := flag.Int("icon-concurrency", fpkgen.DefaultIconConcurrency, "Max entry icons fetched and resized in parallel per package")
+	iconMaxBytes := flag.Int64("icon-max-bytes", fpkgen.DefaultIconLimits.MaxBytes, "Max encoded size of a single icon in bytes")
+	iconMaxPixels := flag.Int("icon-max-pixels", fpkgen.DefaultIconLimits.MaxPixels, "Max decoded width*height of a single icon")
+	eventDebounce := flag.Duration("event-debounce", 2*time.Second, "Quiet period before acting on a container's final state (0 disables coalescing)")
+	inventoryRefresh := flag.Duration("inventory-refresh", fpkgen.DefaultInventoryRefresh, "How often to re-read installed apps from appcenter-cli")
+	generateWorkers := flag.Int("generate-workers", docker.DefaultGenerateWorkers, "Max app packages generated in parallel")
+	readyTimeout := flag.Duration("ready-timeout", docker.DefaultReadyTimeout, "Max wait for a container to become healthy or accept connections on a published port before packaging")
+	reconcileInterval := flag.Duration("reconcile-interval", docker.DefaultReconcileInterval, "How often to diff Docker containers against installed apps")
+	installTimeout := flag.Duration("install-timeout", fpkgen.DefaultCLITimeouts.Install, "Max run time of one appcenter-cli install-local before its process group is killed")
+	cliTimeout := flag.Duration("cli-timeout", fpkgen.DefaultCLITimeouts.Other, "Max run time of other appcenter-cli calls (start, stop, uninstall, list)")
+	batchWindow := flag.Duration("batch-window", docker.DefaultBatchWindow, "How long start/stop/uninstall operations wait to share one appcenter-cli call (negative = no waiting)")
+	uninstallDelay := flag.Duration("uninstall-delay", docker.DefaultUninstallDelay, "How long a destroyed container's app uninstall is held so a recreated container keeps it (negative = immediately)")
+	statusSocket := flag.String("status-socket", docker.DefaultStatusSocket, "Unix socket serving container and queue status as JSON (empty disables)")
+	watchAll := flag.Bool("watch-all", false, "Receive events for and list all containers instead of filtering on watchcow.enable=true in Docker")
+	metricsAddr := flag.String("metrics-addr", "", "Listen address for /metrics and /debug/pprof/ (e.g. 127.0.0.1:9475; empty disables)")
 	flag.Parse()
 
 	// Configure slog
@@ -27,13 +46,19 @@ func main() {
 	opts := &slog.HandlerOptions{
 		Level: logLevel,
 	}
-	handler := slog.NewTextHandler(os.Stdout, opts)
+	// Records logged with a traced context carry its trace_id
+	handler := trace.NewHandler(slog.NewTextHandler(os.Stdout, opts))
 	logger := slog.New(handler)
 	slog.SetDefault(logger)
 
 	slog.Info("WatchCow - fnOS App Generator for Docker")
 	slog.Info("========================================")
 
+	if *metricsAddr != "" {
+		stopMetrics := startMetricsServer(*metricsAddr)
+		defer stopMetrics()
+	}
+
 	// Create context with signal handling
 	ctx, cancel := context.WithCancel(context.Background())
 	defer cancel()
@@ -43,13 +68,41 @@ func main() {
 	signal.Notify(sigChan, os.Interrupt, syscall.SIGTERM)
 
 	// Create and start Docker monitor
-	monitor, err := docker.NewMonitor()
+	monitor, err := docker.NewMonitor(docker.Options{
+		DataDir:         *dataDir,
+		IconConcurrency: *iconConcurrency,
+		IconLimits: fpkgen.IconLimits{
+			MaxBytes:  *iconMaxBytes,
+			MaxPixels: *iconMaxPixels,
+		},
+		EventDebounce:     *eventDebounce,
+		InventoryRefresh:  *inventoryRefresh,
+		GenerateWorkers:   *generateWorkers,
+		ReadyTimeout:      *readyTimeout,
+		ReconcileInterval: *reconcileInterval,
+		CLITimeouts: fpkgen.CLITimeouts{
+			Install: *installTimeout,
+			Other:   *cliTimeout,
+		},
+		BatchWindow:    *batchWindow,
+		UninstallDelay: *uninstallDelay,
+		WatchAll:       *watchAll,
+	})
 	if err != nil {
 		slog.Error("Failed to create Docker monitor", "error", err)
 		os.Exit(1)
 	}
 	defer monitor.Stop()
 
+	if *statusSocket != "" {
+		stopStatus, err := startStatusServer(*statusSocket, monitor.StatusHandler())
+		if err != nil {
+			slog.Warn("Status API disabled", "socket", *statusSocket, "error", err)
+		} else {
+			defer stopStatus()
+		}
+	}
+
 	// Start monitoring
 	go monitor.Start(ctx)
 
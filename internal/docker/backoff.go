@@ -0,0 +1,29 @@
+package docker
+
+import (
+	"math/rand"
+	"time"
+)
+
+// backoff yields exponentially growing retry delays with jitter
+type backoff struct {
+	min, max time.Duration
+	cur      time.Duration
+}
+
+// next returns the delay before the next attempt: the base delay doubles each
+// call up to max, and half of it is randomized so reconnecting clients spread out
+func (b *backoff) next() time.Duration {
+	if b.cur == 0 {
+		b.cur = b.min
+	} else if b.cur *= 2; b.cur > b.max {
+		b.cur = b.max
+	}
+	half := b.cur / 2
+	return half + time.Duration(rand.Int63n(int64(half)+1))
+}
+
+// reset restarts the sequence after a successful attempt
+func (b *backoff) reset() {
+	b.cur = 0
+}
@@ -0,0 +1,32 @@
+package docker
+
+import (
+	"testing"
+	"time"
+)
+
+// TestBackoff_GrowsWithJitterAndCaps tests delay bounds across attempts and after reset
+func TestBackoff_GrowsWithJitterAndCaps(t *testing.T) {
+	b := &backoff{min: 100 * time.Millisecond, max: time.Second}
+
+	bases := []time.Duration{100, 200, 400, 800, 1000, 1000}
+	for i, base := range bases {
+		base *= time.Millisecond
+		d := b.next()
+		if d < base/2 || d > base {
+			t.Errorf("attempt %d: delay %v outside [%v, %v]", i, d, base/2, base)
+		}
+	}
+
+	b.reset()
+	if d := b.next(); d > 100*time.Millisecond {
+		t.Errorf("expected reset to restart at min, got %v", d)
+	}
+}
+
+// TestFormatEventTime tests the since= timestamp format
+func TestFormatEventTime(t *testing.T) {
+	if got := formatEventTime(1700000000_000000042); got != "1700000000.000000042" {
+		t.Errorf("unexpected timestamp %q", got)
+	}
+}
@@ -0,0 +1,151 @@
+package docker
+
+import (
+	"log/slog"
+	"sync"
+	"time"
+
+	"github.com/docker/docker/api/types/events"
+)
+
+// desiredState is the container state implied by a Docker event
+type desiredState int
+
+const (
+	stateUnknown desiredState = iota
+	stateRunning
+	stateStopped
+	stateDestroyed
+)
+
+// String returns the name of the state for logging
+func (s desiredState) String() string {
+	switch s {
+	case stateRunning:
+		return "running"
+	case stateStopped:
+		return "stopped"
+	case stateDestroyed:
+		return "destroyed"
+	}
+	return "unknown"
+}
+
+// stateForAction maps a container event action to the state it leads to
+func stateForAction(action events.Action) desiredState {
+	switch action {
+	case "start":
+		return stateRunning
+	case "stop", "die":
+		return stateStopped
+	case "destroy":
+		return stateDestroyed
+	}
+	return stateUnknown
+}
+
+// eventCoalescer collapses bursts of events for a container into the final
+// desired state. An event is delivered once the container has been quiet for
+// window (or maxDelay after the first event of a burst, so a tight crash loop
+// still converges), and only if that state differs from the last one delivered.
+type eventCoalescer struct {
+	window   time.Duration
+	maxDelay time.Duration
+	deliver  func(event events.Message)
+
+	mu      sync.Mutex
+	pending map[string]*pendingEvent // map[containerID]burst in progress
+	applied map[string]desiredState  // map[containerID]last delivered state
+}
+
+// pendingEvent is a burst of events for one container waiting for its window to expire
+type pendingEvent struct {
+	timer *time.Timer
+	first time.Time
+	last  events.Message
+	state desiredState
+	count int
+}
+
+// newEventCoalescer creates a coalescer; window <= 0 delivers every net transition immediately
+func newEventCoalescer(window time.Duration, deliver func(event events.Message)) *eventCoalescer {
+	return &eventCoalescer{
+		window:   window,
+		maxDelay: 5 * window,
+		deliver:  deliver,
+		pending:  make(map[string]*pendingEvent),
+		applied:  make(map[string]desiredState),
+	}
+}
+
+// add records an event for a container
+func (c *eventCoalescer) add(containerID string, event events.Message) {
+	state := stateForAction(event.Action)
+	if state == stateUnknown {
+		return
+	}
+
+	c.mu.Lock()
+	if c.window <= 0 {
+		c.mu.Unlock()
+		c.flush(containerID, &pendingEvent{last: event, state: state, count: 1})
+		return
+	}
+
+	p, exists := c.pending[containerID]
+	if !exists {
+		p = &pendingEvent{first: time.Now()}
+		p.timer = time.AfterFunc(c.window, func() { c.flush(containerID, p) })
+		c.pending[containerID] = p
+	} else if time.Since(p.first) < c.maxDelay {
+		p.timer.Reset(c.window)
+	}
+	p.last = event
+	p.state = state
+	p.count++
+	c.mu.Unlock()
+}
+
+// settle records a state the container reached outside the event stream,
+// e.g. a reconcile pass acting on missed events, so the next real event is
+// compared against it rather than against the last state delivered here
+func (c *eventCoalescer) settle(containerID string, state desiredState) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	if state == stateDestroyed {
+		delete(c.applied, containerID)
+	} else {
+		c.applied[containerID] = state
+	}
+}
+
+// flush delivers the final event of a burst if it changes the container's state
+func (c *eventCoalescer) flush(containerID string, p *pendingEvent) {
+	c.mu.Lock()
+	if p.timer != nil {
+		if c.pending[containerID] != p {
+			c.mu.Unlock()
+			return // Stale timer for a burst that was already flushed
+		}
+		delete(c.pending, containerID)
+	}
+
+	previous := c.applied[containerID]
+	if p.state == stateDestroyed {
+		delete(c.applied, containerID)
+	} else {
+		c.applied[containerID] = p.state
+	}
+	c.mu.Unlock()
+
+	if p.state == previous {
+		slog.Debug("Coalesced container events without state change",
+			"id", containerID, "state", p.state, "events", p.count)
+		return
+	}
+	if p.count > 1 {
+		slog.Debug("Coalesced container events",
+			"id", containerID, "from", previous, "to", p.state, "events", p.count)
+	}
+	c.deliver(p.last)
+}
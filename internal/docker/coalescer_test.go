@@ -0,0 +1,108 @@
+package docker
+
+import (
+	"sync"
+	"testing"
+	"time"
+
+	"github.com/docker/docker/api/types/events"
+)
+
+// recorder collects delivered event actions
+type recorder struct {
+	mu      sync.Mutex
+	actions []events.Action
+}
+
+func (r *recorder) deliver(event events.Message) {
+	r.mu.Lock()
+	r.actions = append(r.actions, event.Action)
+	r.mu.Unlock()
+}
+
+func (r *recorder) get() []events.Action {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	return append([]events.Action(nil), r.actions...)
+}
+
+func containerEvent(action events.Action) events.Message {
+	return events.Message{Action: action, Actor: events.Actor{ID: "abcdef123456"}}
+}
+
+// TestEventCoalescer_CrashLoopCollapses tests that a start/die storm delivers only the final state
+func TestEventCoalescer_CrashLoopCollapses(t *testing.T) {
+	rec := &recorder{}
+	c := newEventCoalescer(20*time.Millisecond, rec.deliver)
+
+	for i := 0; i < 5; i++ {
+		c.add("abcdef123456", containerEvent("start"))
+		c.add("abcdef123456", containerEvent("die"))
+	}
+	c.add("abcdef123456", containerEvent("start"))
+
+	time.Sleep(80 * time.Millisecond)
+	got := rec.get()
+	if len(got) != 1 || got[0] != "start" {
+		t.Fatalf("expected a single start, got %v", got)
+	}
+
+	// A burst that ends in the already-delivered state is dropped entirely
+	c.add("abcdef123456", containerEvent("die"))
+	c.add("abcdef123456", containerEvent("start"))
+	time.Sleep(80 * time.Millisecond)
+	if got := rec.get(); len(got) != 1 {
+		t.Fatalf("expected no new delivery for start→die→start, got %v", got)
+	}
+}
+
+// TestEventCoalescer_StopThenDestroy tests that die followed by destroy delivers destroy
+func TestEventCoalescer_StopThenDestroy(t *testing.T) {
+	rec := &recorder{}
+	c := newEventCoalescer(20*time.Millisecond, rec.deliver)
+
+	c.add("abcdef123456", containerEvent("die"))
+	c.add("abcdef123456", containerEvent("stop"))
+	c.add("abcdef123456", containerEvent("destroy"))
+
+	time.Sleep(80 * time.Millisecond)
+	got := rec.get()
+	if len(got) != 1 || got[0] != "destroy" {
+		t.Fatalf("expected a single destroy, got %v", got)
+	}
+}
+
+// TestEventCoalescer_NoWindow tests that a zero window delivers net transitions synchronously
+func TestEventCoalescer_NoWindow(t *testing.T) {
+	rec := &recorder{}
+	c := newEventCoalescer(0, rec.deliver)
+
+	c.add("abcdef123456", containerEvent("start"))
+	c.add("abcdef123456", containerEvent("start"))
+	c.add("abcdef123456", containerEvent("die"))
+	c.add("abcdef123456", containerEvent("stop"))
+
+	got := rec.get()
+	if len(got) != 2 || got[0] != "start" || got[1] != "die" {
+		t.Fatalf("expected [start die], got %v", got)
+	}
+}
+
+// TestEventCoalescer_SettleAfterReconcile tests that a die is delivered after
+// a reconcile started a container whose start event was missed
+func TestEventCoalescer_SettleAfterReconcile(t *testing.T) {
+	rec := &recorder{}
+	c := newEventCoalescer(0, rec.deliver)
+
+	c.add("abcdef123456", containerEvent("start"))
+	c.add("abcdef123456", containerEvent("die"))
+
+	// The next start is missed and a reconcile starts the app instead
+	c.settle("abcdef123456", stateRunning)
+
+	c.add("abcdef123456", containerEvent("die"))
+	got := rec.get()
+	if len(got) != 3 || got[2] != "die" {
+		t.Fatalf("expected [start die die], got %v", got)
+	}
+}
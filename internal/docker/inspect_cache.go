@@ -0,0 +1,69 @@
+package docker
+
+import (
+	"context"
+	"sync"
+	"time"
+
+	"github.com/docker/docker/api/types/container"
+)
+
+// inspectCacheTTL is how long an inspect result is reused. It only needs to
+// span one start event: event filter, readiness check and generation.
+const inspectCacheTTL = 5 * time.Second
+
+// inspectCache is a short-lived cache of ContainerInspect results keyed by container ID
+type inspectCache struct {
+	ttl   time.Duration
+	fetch func(ctx context.Context, containerID string) (container.InspectResponse, error)
+
+	mu      sync.Mutex
+	entries map[string]inspectEntry
+}
+
+type inspectEntry struct {
+	info    container.InspectResponse
+	fetched time.Time
+}
+
+// newInspectCache creates a cache that calls fetch on misses
+func newInspectCache(ttl time.Duration, fetch func(ctx context.Context, containerID string) (container.InspectResponse, error)) *inspectCache {
+	return &inspectCache{ttl: ttl, fetch: fetch, entries: make(map[string]inspectEntry)}
+}
+
+// get returns a cached inspect result younger than ttl, fetching it otherwise
+func (c *inspectCache) get(ctx context.Context, containerID string) (container.InspectResponse, error) {
+	c.mu.Lock()
+	entry, ok := c.entries[containerID]
+	c.mu.Unlock()
+	if ok && time.Since(entry.fetched) < c.ttl {
+		return entry.info, nil
+	}
+	return c.refresh(ctx, containerID)
+}
+
+// refresh fetches a fresh inspect result and caches it
+func (c *inspectCache) refresh(ctx context.Context, containerID string) (container.InspectResponse, error) {
+	info, err := c.fetch(ctx, containerID)
+	if err != nil {
+		return info, err
+	}
+
+	now := time.Now()
+	c.mu.Lock()
+	for id, e := range c.entries {
+		if now.Sub(e.fetched) >= c.ttl {
+			delete(c.entries, id)
+		}
+	}
+	c.entries[containerID] = inspectEntry{info: info, fetched: now}
+	c.mu.Unlock()
+	return info, nil
+}
+
+// invalidate drops the cached result for a container
+func (c *inspectCache) invalidate(containerID string) {
+	c.mu.Lock()
+	delete(c.entries, containerID)
+	c.mu.Unlock()
+}
@@ -0,0 +1,36 @@
+package docker
+
+import (
+	"context"
+	"testing"
+	"time"
+
+	"github.com/docker/docker/api/types/container"
+)
+
+// TestInspectCache_ReusesWithinTTL tests that repeated lookups within the TTL cost one fetch
+func TestInspectCache_ReusesWithinTTL(t *testing.T) {
+	fetches := 0
+	c := newInspectCache(time.Hour, func(ctx context.Context, id string) (container.InspectResponse, error) {
+		fetches++
+		return container.InspectResponse{ContainerJSONBase: &container.ContainerJSONBase{ID: id}}, nil
+	})
+
+	for i := 0; i < 3; i++ {
+		info, err := c.get(context.Background(), "abcdef123456")
+		if err != nil || info.ID != "abcdef123456" {
+			t.Fatalf("unexpected result %+v, %v", info, err)
+		}
+	}
+	if fetches != 1 {
+		t.Errorf("expected 1 fetch, got %d", fetches)
+	}
+
+	c.invalidate("abcdef123456")
+	if _, err := c.get(context.Background(), "abcdef123456"); err != nil {
+		t.Fatalf("get after invalidate failed: %v", err)
+	}
+	if fetches != 2 {
+		t.Errorf("expected invalidate to force a fetch, got %d fetches", fetches)
+	}
+}
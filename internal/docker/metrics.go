@@ -0,0 +1,35 @@
+package docker
+
+import (
+	"context"
+	"time"
+
+	"github.com/docker/docker/api/types/container"
+	"github.com/docker/docker/client"
+
+	"watchcow/internal/metrics"
+)
+
+var (
+	eventsTotal = metrics.NewCounterVec("watchcow_docker_events_total",
+		"Docker container events received, by action.", "action")
+	dockerAPIDuration = metrics.NewHistogramVec("watchcow_docker_api_duration_seconds",
+		"Latency of Docker API calls, by call.", "call", metrics.DefBuckets)
+	queueDepth = metrics.NewGauge("watchcow_operation_queue_depth",
+		"appcenter-cli operations waiting to run.")
+	queueWait = metrics.NewHistogramVec("watchcow_operation_queue_wait_seconds",
+		"Time operations spent queued before running, by operation type.", "op", metrics.SlowBuckets)
+)
+
+// observeDockerCall records the latency of a Docker API call started at start
+func observeDockerCall(call string, start time.Time) {
+	dockerAPIDuration.Since(call, start)
+}
+
+// timedInspect wraps ContainerInspect with latency recording
+func timedInspect(cli *client.Client) func(ctx context.Context, containerID string) (container.InspectResponse, error) {
+	return func(ctx context.Context, containerID string) (container.InspectResponse, error) {
+		defer observeDockerCall("inspect", time.Now())
+		return cli.ContainerInspect(ctx, containerID)
+	}
+}
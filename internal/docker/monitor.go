@@ -2,55 +2,163 @@ package docker
 
 import (
 	"context"
+	"errors"
 	"fmt"
 	"log/slog"
 	"os"
-	"strings"
+	"path/filepath"
 	"sync"
+	"sync/atomic"
 	"time"
 
-	"github.com/docker/docker/api/types/container"
 	"github.com/docker/docker/api/types/events"
 	"github.com/docker/docker/api/types/filters"
 	"github.com/docker/docker/client"
 
 	"watchcow/internal/fpkgen"
+	"watchcow/internal/trace"
 )
 
 // AppOperation represents an appcenter-cli operation
 type AppOperation struct {
-	Type     string // "install", "stop", "uninstall"
+	Type     string // "install", "upgrade", "start", "stop", "uninstall"
 	AppName  string
 	AppDir   string
 	ResultCh chan error
+	Trace    *trace.Span // Span of the requester; the operation is traced as part of it
 }
 
 // Monitor watches Docker containers and manages fnOS app installation
 type Monitor struct {
-	cli       *client.Client
+	cli       *client.Client // Shared with the generator
+	inspect   *inspectCache  // Short-lived ContainerInspect results for the start path
 	generator *fpkgen.Generator
-	installer *fpkgen.Installer
+	installer fpkgen.Installer
+	inventory *fpkgen.AppInventory // Installed-app index (nil without installer)
 	stopCh    chan struct{}
 
-	// Track container states
-	containers map[string]*ContainerState // map[containerID]state
-	mu         sync.RWMutex
-
-	// Operation queue for serializing appcenter-cli calls
-	opQueue chan *AppOperation
+	// Track container states; work for one container runs on its actor
+	containers *containerTable
+	actors     *actors
+	store      *stateStore                       // Persists containers across restarts (nil = memory only)
+	status     *fpkgen.StatusFiles               // Run state read by generated cmd/main (nil = disabled)
+	statusMu   sync.Mutex                        // Serializes publishStatus and syncStatus
+	statusAt   map[string]time.Time              // When an event last wrote each status file, under statusMu
+	snapshotMu sync.Mutex                        // Serializes publishSnapshot
+	snapshot   atomic.Pointer[StatusSnapshot]    // Published after every change, read lock-free
+	running    atomic.Pointer[[]QueuedOperation] // Operations the worker is executing
+
+	// Operation scheduler for serializing appcenter-cli calls
+	ops           *opScheduler
+	workerDone    chan struct{} // Closed when the operation worker exits
+	workerStarted atomic.Bool
+	batchWindow   time.Duration // Wait for same-type operations to batch with
+
+	// Collapses per-container event bursts before they reach handleDockerEvent
+	eventDebounce time.Duration
+	coalescer     *eventCoalescer
+	lastEventNano atomic.Int64 // Timestamp of the last received event, for since= on reconnect
+
+	inventoryRefresh time.Duration
+
+	// Bounded pool for package generation; installs are serialized separately
+	generateSlots chan struct{}
+	readyTimeout  time.Duration
+
+	// Periodic and on-demand diff of Docker state against tracked state
+	reconcileInterval time.Duration
+	reconcileCh       chan struct{}
+
+	watchAll bool // Skip server-side label filters on events and lists
 }
 
+// DefaultGenerateWorkers is the number of packages generated concurrently
+const DefaultGenerateWorkers = 4
+
+// DefaultBatchWindow is how long the worker waits for more start, stop or
+// uninstall operations to join one appcenter-cli invocation
+const DefaultBatchWindow = 100 * time.Millisecond
+
+// DefaultUninstallDelay is how long a destroyed container's uninstall is held.
+// It exceeds DefaultReadyTimeout, so a recreated container that waits for its
+// healthcheck still takes the installed app over instead of reinstalling it.
+const DefaultUninstallDelay = 45 * time.Second
+
+// maxBatchSize caps the apps passed to one appcenter-cli invocation
+const maxBatchSize = 32
+
+// stopWorkerTimeout bounds how long Stop waits for a cancelled operation to exit
+const stopWorkerTimeout = 10 * time.Second
+
 // ContainerState tracks the state of a monitored container
 type ContainerState struct {
-	ContainerID   string
-	ContainerName string
-	AppName       string
-	Installed     bool
-	Labels        map[string]string
+	ContainerID   string            `json:"container_id"`
+	ContainerName string            `json:"container_name"`
+	AppName       string            `json:"app_name"`
+	Installed     bool              `json:"installed"`
+	Labels        map[string]string `json:"labels,omitempty"`
+	PackageHash   string            `json:"package_hash,omitempty"` // Hash of the last generated package
+	Stopped       bool              `json:"stopped,omitempty"`      // App was stopped after the container stopped
+}
+
+// Options configures a Monitor
+type Options struct {
+	// DataDir holds persistent state such as the icon cache and the
+	// container state snapshot. Empty disables everything that needs to
+	// survive a restart.
+	DataDir string
+
+	// IconConcurrency limits parallel icon fetch/resize jobs per package
+	// (0 = fpkgen.DefaultIconConcurrency).
+	IconConcurrency int
+
+	// IconLimits caps the encoded size and pixel count of a single icon
+	// (zero value = fpkgen.DefaultIconLimits).
+	IconLimits fpkgen.IconLimits
+
+	// EventDebounce is how long a container must be quiet before its final
+	// state is acted upon (0 = act on every event immediately).
+	EventDebounce time.Duration
+
+	// InventoryRefresh is how often the installed-app index is re-read
+	// from appcenter-cli (0 = fpkgen.DefaultInventoryRefresh).
+	InventoryRefresh time.Duration
+
+	// GenerateWorkers limits concurrent package generation
+	// (0 = DefaultGenerateWorkers).
+	GenerateWorkers int
+
+	// ReadyTimeout bounds the wait for a container to become healthy or
+	// bind its ports before its package is generated (0 = DefaultReadyTimeout).
+	ReadyTimeout time.Duration
+
+	// ReconcileInterval is how often the container list is diffed against
+	// tracked state to catch missed events (0 = DefaultReconcileInterval).
+	ReconcileInterval time.Duration
+
+	// CLITimeouts bounds each appcenter-cli run (zero fields =
+	// fpkgen.DefaultCLITimeouts).
+	CLITimeouts fpkgen.CLITimeouts
+
+	// BatchWindow is how long a start, stop or uninstall waits for others
+	// to share its appcenter-cli invocation, when the CLI accepts several
+	// app names (0 = DefaultBatchWindow, negative = only batch operations
+	// already queued).
+	BatchWindow time.Duration
+
+	// UninstallDelay holds the uninstall of a destroyed container's app, so
+	// a recreate (docker compose up --force-recreate) keeps the installed
+	// app (0 = DefaultUninstallDelay, negative = uninstall immediately).
+	UninstallDelay time.Duration
+
+	// WatchAll subscribes to events of, and lists, every container instead
+	// of filtering on watchcow.enable=true in dockerd. Labels are still
+	// checked in watchcow; this only costs more events and list entries.
+	WatchAll bool
 }
 
 // NewMonitor creates a new Docker monitor
-func NewMonitor() (*Monitor, error) {
+func NewMonitor(opts Options) (*Monitor, error) {
 	// Connect to Docker daemon
 	cli, err := client.NewClientWithOpts(client.FromEnv, client.WithAPIVersionNegotiation())
 	if err != nil {
@@ -58,162 +166,452 @@ func NewMonitor() (*Monitor, error) {
 	}
 
 	// Create generator
-	generator, err := fpkgen.NewGenerator()
+	genOpts := []fpkgen.GeneratorOption{
+		fpkgen.WithDockerClient(cli),
+		fpkgen.WithIconConcurrency(opts.IconConcurrency),
+	}
+	if opts.IconLimits != (fpkgen.IconLimits{}) {
+		genOpts = append(genOpts, fpkgen.WithIconLimits(opts.IconLimits))
+	}
+	if opts.DataDir != "" {
+		iconCache, err := fpkgen.NewIconCache(filepath.Join(opts.DataDir, "icon-cache"), fpkgen.DefaultIconCacheTTL)
+		if err != nil {
+			slog.Warn("Icon cache disabled", "error", err)
+		} else {
+			genOpts = append(genOpts, fpkgen.WithIconCache(iconCache))
+		}
+	}
+
+	var store *stateStore
+	if opts.DataDir != "" {
+		store = newStateStore(filepath.Join(opts.DataDir, "state.json"))
+	}
+
+	generator, err := fpkgen.NewGenerator(genOpts...)
 	if err != nil {
 		cli.Close()
 		return nil, fmt.Errorf("failed to create generator: %w", err)
 	}
 
 	// Try to create installer (may fail if appcenter-cli not available)
-	installer, err := fpkgen.NewInstaller()
+	var inventory *fpkgen.AppInventory
+	installer, err := fpkgen.NewInstaller(
+		fpkgen.WithCLITimeouts(opts.CLITimeouts),
+	)
 	if err != nil {
 		slog.Warn("appcenter-cli not available, will only generate app packages", "error", err)
 		// Continue without installer - useful for development/testing
 	} else {
-		slog.Info("Installer ready, apps will be auto-installed via appcenter-cli")
+		slog.Info("Installer ready, apps will be auto-installed")
+		inventory = fpkgen.NewAppInventory(installer)
+	}
+
+	// Installed apps poll their status from files we keep current
+	var status *fpkgen.StatusFiles
+	if installer != nil {
+		if status, err = fpkgen.OpenStatusFiles(fpkgen.StatusDir); err != nil {
+			slog.Warn("Status files disabled, app status checks will query Docker", "error", err)
+		}
+	}
+
+	inventoryRefresh := opts.InventoryRefresh
+	if inventoryRefresh <= 0 {
+		inventoryRefresh = fpkgen.DefaultInventoryRefresh
+	}
+	generateWorkers := opts.GenerateWorkers
+	if generateWorkers <= 0 {
+		generateWorkers = DefaultGenerateWorkers
+	}
+	readyTimeout := opts.ReadyTimeout
+	if readyTimeout <= 0 {
+		readyTimeout = DefaultReadyTimeout
+	}
+	batchWindow := opts.BatchWindow
+	if batchWindow == 0 {
+		batchWindow = DefaultBatchWindow
+	}
+	reconcileInterval := opts.ReconcileInterval
+	if reconcileInterval <= 0 {
+		reconcileInterval = DefaultReconcileInterval
+	}
+	uninstallDelay := opts.UninstallDelay
+	if uninstallDelay == 0 {
+		uninstallDelay = DefaultUninstallDelay
 	}
 
-	return &Monitor{
-		cli:        cli,
-		generator:  generator,
-		installer:  installer,
-		stopCh:     make(chan struct{}),
-		containers: make(map[string]*ContainerState),
-		opQueue:    make(chan *AppOperation, 100),
-	}, nil
+	m := &Monitor{
+		cli:               cli,
+		inspect:           newInspectCache(inspectCacheTTL, timedInspect(cli)),
+		generator:         generator,
+		installer:         installer,
+		inventory:         inventory,
+		stopCh:            make(chan struct{}),
+		actors:            newActors(),
+		store:             store,
+		status:            status,
+		ops:               newOpScheduler(),
+		workerDone:        make(chan struct{}),
+		batchWindow:       batchWindow,
+		eventDebounce:     opts.EventDebounce,
+		inventoryRefresh:  inventoryRefresh,
+		generateSlots:     make(chan struct{}, generateWorkers),
+		readyTimeout:      readyTimeout,
+		reconcileInterval: reconcileInterval,
+		reconcileCh:       make(chan struct{}, 1),
+		watchAll:          opts.WatchAll,
+	}
+	m.containers = newContainerTable(m.publishSnapshot)
+	m.ops.uninstallDelay = uninstallDelay
+	return m, nil
 }
 
-// runOperationWorker processes appcenter-cli operations sequentially
+// runOperationWorker processes appcenter-cli operations sequentially.
+// Stop cancels the running operation, which kills its process group, and
+// operations still queued fail with ErrMonitorStopped.
 func (m *Monitor) runOperationWorker(ctx context.Context) {
-	for {
+	defer close(m.workerDone)
+	defer m.ops.close(ErrMonitorStopped)
+	ctx, cancel := context.WithCancel(ctx)
+	defer cancel()
+	go func() {
 		select {
-		case <-ctx.Done():
-			return
 		case <-m.stopCh:
+			cancel()
+		case <-ctx.Done():
+		}
+	}()
+
+	for {
+		batch, ok := m.ops.popBatch(ctx, m.stopCh, m.batchable, m.batchWindow, maxBatchSize)
+		if !ok {
 			return
-		case op := <-m.opQueue:
-			var err error
-			switch op.Type {
-			case "install":
-				slog.Info("Installing fnOS app", "app", op.AppName)
-				err = m.installer.InstallLocal(op.AppDir)
-				// Clean up temp directory after install (success or fail)
-				os.RemoveAll(op.AppDir)
-			case "start":
-				slog.Info("Starting fnOS app", "app", op.AppName)
-				err = m.installer.StartApp(op.AppName)
-			case "stop":
-				slog.Info("Stopping fnOS app", "app", op.AppName)
-				err = m.installer.StopApp(op.AppName)
-			case "uninstall":
-				slog.Info("Uninstalling fnOS app", "app", op.AppName)
-				err = m.installer.Uninstall(op.AppName)
-			}
-			if op.ResultCh != nil {
-				op.ResultCh <- err
-			}
 		}
+		m.setRunning(batch)
+		if len(batch) == 1 {
+			m.runOperation(ctx, batch[0])
+		} else {
+			m.runBatch(ctx, batch)
+		}
+		m.setRunning(nil)
 	}
 }
 
+// runOperation runs one queued operation and delivers its result
+func (m *Monitor) runOperation(ctx context.Context, op *scheduledOp) {
+	// Continue the requester's trace, so the CLI run shows up in its phases
+	op.Trace.Record("queue_wait", time.Since(op.queuedAt))
+	opCtx, span := trace.Start(trace.ContextWithSpan(ctx, op.Trace), op.Type, "app", op.AppName)
+
+	var err error
+	switch op.Type {
+	case "install":
+		slog.InfoContext(opCtx, "Installing fnOS app", "app", op.AppName)
+		err = m.installer.InstallLocal(opCtx, op.AppDir)
+		// Clean up temp directory after install (success or fail)
+		os.RemoveAll(op.AppDir)
+	case "upgrade":
+		slog.InfoContext(opCtx, "Upgrading fnOS app", "app", op.AppName)
+		// Installing over an app that is still installed would fail or mix
+		// versions, so a failed uninstall aborts the upgrade
+		if err = m.installer.Uninstall(opCtx, op.AppName); err == nil {
+			err = m.installer.InstallLocal(opCtx, op.AppDir)
+		}
+		os.RemoveAll(op.AppDir)
+	case "start":
+		slog.InfoContext(opCtx, "Starting fnOS app", "app", op.AppName)
+		err = m.installer.StartApp(opCtx, op.AppName)
+	case "stop":
+		slog.InfoContext(opCtx, "Stopping fnOS app", "app", op.AppName)
+		err = m.installer.StopApp(opCtx, op.AppName)
+	case "uninstall":
+		slog.InfoContext(opCtx, "Uninstalling fnOS app", "app", op.AppName)
+		err = m.installer.Uninstall(opCtx, op.AppName)
+	}
+	span.End(err)
+	op.complete(err)
+}
+
+// runBatch runs same-type operations for several apps as one appcenter-cli
+// invocation. The run is traced under the first requester's trace; the
+// others record it as a phase.
+func (m *Monitor) runBatch(ctx context.Context, batch []*scheduledOp) {
+	opType := batch[0].Type
+	names := make([]string, len(batch))
+	for n, op := range batch {
+		op.Trace.Record("queue_wait", time.Since(op.queuedAt))
+		names[n] = op.AppName
+	}
+
+	start := time.Now()
+	opCtx, span := trace.Start(trace.ContextWithSpan(ctx, batch[0].Trace), opType+"_batch", "apps", len(batch))
+	var errs []error
+	switch opType {
+	case "start":
+		errs = m.installer.StartApps(opCtx, names)
+	case "stop":
+		errs = m.installer.StopApps(opCtx, names)
+	case "uninstall":
+		errs = m.installer.UninstallApps(opCtx, names)
+	}
+	span.End(errors.Join(errs...))
+
+	for n, op := range batch {
+		if n > 0 {
+			op.Trace.Record(opType+"_batch", time.Since(start))
+		}
+		op.complete(errs[n])
+	}
+}
+
+// batchable reports whether queued operations of opType may share one
+// appcenter-cli invocation
+func (m *Monitor) batchable(opType string) bool {
+	if !isRunOp(opType) && opType != "uninstall" {
+		return false
+	}
+	return m.installer.SupportsBatch(opType)
+}
+
 // queueOperation sends an operation to the worker and waits for result
-func (m *Monitor) queueOperation(opType, appName, appDir string) error {
+// Returns ErrOperationSuperseded if a later operation made this one redundant
+func (m *Monitor) queueOperation(ctx context.Context, opType, appName, appDir string) error {
 	if m.installer == nil {
 		return nil
 	}
 	resultCh := make(chan error, 1)
-	m.opQueue <- &AppOperation{
+	m.ops.push(&AppOperation{
 		Type:     opType,
 		AppName:  appName,
 		AppDir:   appDir,
 		ResultCh: resultCh,
-	}
+		Trace:    trace.FromContext(ctx),
+	})
 	return <-resultCh
 }
 
+// QueueDepth returns the number of appcenter-cli operations waiting to run
+func (m *Monitor) QueueDepth() int {
+	return m.ops.Len()
+}
+
 // Start starts monitoring Docker containers
 func (m *Monitor) Start(ctx context.Context) {
 	slog.Info("Starting Docker monitor...")
 
+	// Restore tracked containers from the last run
+	if m.store != nil {
+		containers, err := m.store.load()
+		if err != nil {
+			slog.Warn("Ignoring saved container state", "error", err)
+		} else {
+			m.containers.replace(containers)
+			slog.Info("Restored container state", "count", len(containers))
+		}
+	}
+	m.publishSnapshot()
+
 	// Start operation worker for serializing appcenter-cli calls
 	if m.installer != nil {
+		m.workerStarted.Store(true)
 		go m.runOperationWorker(ctx)
+
+		// Load the installed-app index once, before the scan needs it
+		if err := m.inventory.Refresh(ctx); err != nil {
+			slog.Warn("Failed to load installed app inventory", "error", err)
+		}
+		go m.inventory.Run(ctx, m.inventoryRefresh)
 	}
 
-	// Initial scan to process existing containers
-	m.scanContainers(ctx)
+	m.coalescer = newEventCoalescer(m.eventDebounce, func(event events.Message) {
+		m.handleDockerEvent(ctx, event)
+	})
 
 	// Start listening to Docker events for real-time updates
 	go m.listenToDockerEvents(ctx)
+
+	// Converge with containers that changed while we were not watching
+	go m.runReconciler(ctx)
 }
 
-// listenToDockerEvents listens to Docker daemon events
+// Event stream reconnect tuning
+const (
+	eventRetryMin = 500 * time.Millisecond
+	eventRetryMax = 30 * time.Second
+
+	// maxReplayGap is the longest outage replayed with since=; dockerd only
+	// buffers recent events, so longer gaps also trigger a reconcile pass
+	maxReplayGap = 5 * time.Minute
+)
+
+// listenToDockerEvents listens to Docker daemon events.
+// On stream errors it reconnects with exponential backoff and since= set to
+// the last processed event, so events emitted during the gap are replayed.
 func (m *Monitor) listenToDockerEvents(ctx context.Context) {
-	// Set up event filters
-	eventFilters := filters.NewArgs()
-	eventFilters.Add("type", "container")
-	eventFilters.Add("event", "start")
-	eventFilters.Add("event", "stop")
-	eventFilters.Add("event", "die")
-	eventFilters.Add("event", "destroy")
-
-	eventChan, errChan := m.cli.Events(ctx, events.ListOptions{
-		Filters: eventFilters,
-	})
+	eventFilters := containerEventFilters(m.watchAll)
+
+	// Nothing before the first subscription needs replaying; reconcile covers it
+	m.lastEventNano.CompareAndSwap(0, time.Now().UnixNano())
 
+	retry := &backoff{min: eventRetryMin, max: eventRetryMax}
 	for {
+		opts := events.ListOptions{
+			Filters: eventFilters,
+			Since:   formatEventTime(m.lastEventNano.Load()),
+		}
+
+		err := m.consumeEvents(ctx, opts, retry)
+		if err == nil {
+			return
+		}
+
+		delay := retry.next()
+		slog.Warn("Docker event stream error, reconnecting...", "error", err, "retry_in", delay, "since", opts.Since)
 		select {
 		case <-ctx.Done():
 			return
 		case <-m.stopCh:
 			return
+		case <-time.After(delay):
+		}
+
+		if gap := time.Since(time.Unix(0, m.lastEventNano.Load())); gap > maxReplayGap {
+			slog.Info("Event gap too long to replay, reconciling", "gap", gap.Round(time.Second))
+			m.requestReconcile()
+		}
+	}
+}
+
+// consumeEvents reads one event stream until it fails (returns the error) or
+// the monitor stops (returns nil)
+func (m *Monitor) consumeEvents(ctx context.Context, opts events.ListOptions, retry *backoff) error {
+	// Cancelling the stream context releases the client's stream goroutine
+	streamCtx, cancel := context.WithCancel(ctx)
+	defer cancel()
+
+	eventChan, errChan := m.cli.Events(streamCtx, opts)
+	for {
+		select {
+		case <-ctx.Done():
+			return nil
+		case <-m.stopCh:
+			return nil
 		case err := <-errChan:
-			if err != nil {
-				slog.Warn("Docker event stream error, reconnecting...", "error", err)
-				time.Sleep(5 * time.Second)
-				go m.listenToDockerEvents(ctx)
-				return
+			if err == nil {
+				err = fmt.Errorf("event stream closed")
 			}
+			return err
 		case event := <-eventChan:
-			m.handleDockerEvent(ctx, event)
+			retry.reset()
+			if event.TimeNano > 0 {
+				m.lastEventNano.Store(event.TimeNano)
+			} else if event.Time > 0 {
+				m.lastEventNano.Store(time.Unix(event.Time, 0).UnixNano())
+			}
+			eventsTotal.Inc(string(event.Action))
+			m.publishStatus(event)
+			m.coalescer.add(shortID(event.Actor.ID), event)
 		}
 	}
 }
 
-// handleDockerEvent processes a Docker event
+// managedLabel is the server-side label filter for containers watchcow may
+// manage. Labels are fixed at container creation, so every lifecycle event
+// of a managed container still matches.
+const managedLabel = "watchcow.enable=true"
+
+// containerEventFilters selects the lifecycle events the monitor handles,
+// only for managed containers unless watchAll is set
+func containerEventFilters(watchAll bool) filters.Args {
+	args := filters.NewArgs()
+	args.Add("type", "container")
+	args.Add("event", "start")
+	args.Add("event", "stop")
+	args.Add("event", "die")
+	args.Add("event", "destroy")
+	if !watchAll {
+		args.Add("label", managedLabel)
+	}
+	return args
+}
+
+// containerListFilters selects the containers a reconcile pass lists
+func containerListFilters(watchAll bool) filters.Args {
+	args := filters.NewArgs()
+	if !watchAll {
+		args.Add("label", managedLabel)
+	}
+	return args
+}
+
+// formatEventTime formats a UnixNano timestamp in the seconds.nanoseconds
+// form accepted by the since/until event filters
+func formatEventTime(nano int64) string {
+	return fmt.Sprintf("%d.%09d", nano/int64(time.Second), nano%int64(time.Second))
+}
+
+// handleDockerEvent processes a Docker event. The handler runs on the
+// container's actor, after any earlier work for the same container.
 func (m *Monitor) handleDockerEvent(ctx context.Context, event events.Message) {
 	containerName := event.Actor.Attributes["name"]
-	containerID := event.Actor.ID
-	if len(containerID) > 12 {
-		containerID = containerID[:12]
-	}
+	containerID := shortID(event.Actor.ID)
+
+	// Each event starts a trace that follows it through generation and install
+	ctx, span := trace.Start(ctx, "docker_event", "action", event.Action, "container", containerName)
 
 	switch event.Action {
 	case "start":
-		slog.Info("Container started", "container", containerName, "id", containerID)
+		slog.InfoContext(ctx, "Container started", "container", containerName, "id", containerID)
 
-		// Inspect container to get full labels (event.Actor.Attributes is incomplete)
-		info, err := m.cli.ContainerInspect(ctx, containerID)
-		if err != nil {
-			slog.Debug("Failed to inspect container", "container", containerName, "error", err)
+		// Event attributes carry the container labels, so unmanaged containers
+		// are skipped without an inspect
+		if !shouldInstall(event.Actor.Attributes) {
+			span.End(nil)
 			return
 		}
 
-		labels := info.Config.Labels
-		if shouldInstall(labels) {
-			go m.handleContainerStart(ctx, containerID, containerName, labels)
-		}
+		m.actors.submit(containerID, func() {
+			// Inspect container to get full labels (event.Actor.Attributes is incomplete)
+			info, err := m.inspect.get(ctx, containerID)
+			if err != nil {
+				slog.DebugContext(ctx, "Failed to inspect container", "container", containerName, "error", err)
+				span.End(err)
+				return
+			}
+			if labels := info.Config.Labels; shouldInstall(labels) {
+				m.handleContainerStart(ctx, containerID, containerName, labels)
+			}
+			span.End(nil)
+		})
 
 	case "stop", "die":
-		slog.Info("Container stopped", "container", containerName, "id", containerID)
-		m.handleContainerStop(ctx, containerID, containerName)
+		slog.InfoContext(ctx, "Container stopped", "container", containerName, "id", containerID)
+		m.inspect.invalidate(containerID)
+		m.actors.submit(containerID, func() {
+			m.handleContainerStop(ctx, containerID, containerName)
+			span.End(nil)
+		})
 
 	case "destroy":
-		slog.Info("Container destroyed", "container", containerName, "id", containerID)
-		m.handleContainerDestroy(ctx, containerID, containerName)
+		slog.InfoContext(ctx, "Container destroyed", "container", containerName, "id", containerID)
+		m.inspect.invalidate(containerID)
+		m.actors.submit(containerID, func() {
+			m.handleContainerDestroy(ctx, containerID, containerName)
+			span.End(nil)
+		})
+
+	default:
+		span.End(nil)
 	}
 }
 
+// shortID returns the 12-character short form of a container ID
+func shortID(id string) string {
+	if len(id) > 12 {
+		return id[:12]
+	}
+	return id
+}
+
 // getAppNameFromLabels extracts appName from labels
 func getAppNameFromLabels(labels map[string]string, containerName string) string {
 	appName := labels["watchcow.appname"]
@@ -235,148 +633,256 @@ func shouldInstall(labels map[string]string) bool {
 	return installMode == "fnos" || installMode == "true" || installMode == ""
 }
 
-// handleContainerStart handles container start event
+// handleContainerStart handles container start event; call it on the container's actor.
+// The package is rendered in memory and only written out for install-local
+// if its hash differs from the installed copy (install if absent, upgrade if
+// changed). A recreated container finds its app still installed, since the
+// old container's uninstall is held back (see opScheduler.uninstallDelay).
 func (m *Monitor) handleContainerStart(ctx context.Context, containerID, containerName string, labels map[string]string) {
-	appName := getAppNameFromLabels(labels, containerName)
+	ctx, span := trace.Start(ctx, "container_start", "container", containerName)
+	defer span.End(nil)
 
-	// Check if already installed in fnOS
-	if m.installer != nil && m.installer.IsAppInstalled(appName) {
-		// Already installed, just start it
-		slog.Info("App already installed, starting", "app", appName)
-		if err := m.queueOperation("start", appName, ""); err != nil {
-			slog.Warn("Failed to start fnOS app", "app", appName, "error", err)
-		}
-
-		// Track in memory
-		m.mu.Lock()
-		m.containers[containerID] = &ContainerState{
-			ContainerID:   containerID,
-			ContainerName: containerName,
-			AppName:       appName,
-			Installed:     true,
-			Labels:        labels,
-		}
-		m.mu.Unlock()
+	if m.resumeInstalled(ctx, containerID) {
 		return
 	}
 
-	// Not installed yet, generate and install
-	time.Sleep(2 * time.Second)
+	appName := getAppNameFromLabels(labels, containerName)
+	installed := m.inventory != nil && m.inventory.Has(ctx, appName)
+
+	readyCtx, readySpan := trace.Start(ctx, "wait_ready")
+	err := m.waitContainerReady(readyCtx, containerID)
+	readySpan.End(err)
+	if err != nil {
+		slog.WarnContext(ctx, "Container not ready, skipping", "container", containerName, "error", err)
+		return
+	}
 
-	config, appDir, err := m.generator.GenerateFromContainer(ctx, containerID)
+	// Render in the bounded pool, then install via the serialized queue
+	pkg, err := m.renderPackage(ctx, containerID)
 	if err != nil {
-		slog.Error("Failed to generate fnOS app", "container", containerName, "error", err)
+		slog.ErrorContext(ctx, "Failed to generate fnOS app", "container", containerName, "error", err)
 		return
 	}
+	config := pkg.Config
 
 	// Record state
-	m.mu.Lock()
-	m.containers[containerID] = &ContainerState{
+	m.containers.put(ContainerState{
 		ContainerID:   containerID,
 		ContainerName: containerName,
 		AppName:       config.AppName,
-		Installed:     false,
+		Installed:     installed,
 		Labels:        labels,
+		PackageHash:   config.PackageHash,
+	})
+
+	if installed && config.PackageHash == m.installer.InstalledPackageHash(config.AppName) {
+		// Identical package already installed, just start it
+		slog.InfoContext(ctx, "App already installed and unchanged, starting", "app", config.AppName)
+		if err := m.queueOperation(ctx, "start", config.AppName, ""); err != nil && !errors.Is(err, ErrOperationSuperseded) {
+			slog.WarnContext(ctx, "Failed to start fnOS app", "app", config.AppName, "error", err)
+			// The app may have been removed behind our back
+			m.inventory.Invalidate()
+		}
+		m.persistState()
+		return
+	}
+
+	appDir, err := pkg.WriteTemp(ctx)
+	if err != nil {
+		slog.ErrorContext(ctx, "Failed to generate fnOS app", "container", containerName, "error", err)
+		return
+	}
+	opType := "install"
+	if installed {
+		opType = "upgrade"
+		slog.InfoContext(ctx, "Package changed, upgrading", "app", config.AppName)
 	}
-	m.mu.Unlock()
 
-	// Install via queue (serialized)
-	if err := m.queueOperation("install", config.AppName, appDir); err != nil {
-		slog.Error("Failed to install fnOS app", "app", config.AppName, "error", err)
+	if err := m.queueOperation(ctx, opType, config.AppName, appDir); err != nil {
+		if errors.Is(err, ErrOperationSuperseded) {
+			slog.InfoContext(ctx, "Install superseded before it ran", "app", config.AppName)
+			return
+		}
+		slog.ErrorContext(ctx, "Failed to install fnOS app", "app", config.AppName, "error", err)
+		if installed {
+			m.inventory.Invalidate()
+		}
 		return
 	}
 
-	m.mu.Lock()
-	if state, exists := m.containers[containerID]; exists {
+	m.containers.update(containerID, func(state *ContainerState) bool {
 		state.Installed = true
+		return true
+	})
+	if m.inventory != nil {
+		m.inventory.Add(config.AppName)
 	}
-	m.mu.Unlock()
-	slog.Info("Successfully installed fnOS app", "app", config.AppName, "container", containerName)
-	m.generator.MarkInstalled(containerID, config)
+	m.persistState()
+	slog.InfoContext(ctx, "Successfully installed fnOS app", "app", config.AppName, "container", containerName)
 }
 
-// handleContainerStop handles container stop event (stop app, keep installed)
-func (m *Monitor) handleContainerStop(ctx context.Context, containerID, containerName string) {
-	m.mu.RLock()
-	state, exists := m.containers[containerID]
-	m.mu.RUnlock()
+// resumeInstalled starts the app of a container that is already tracked as
+// installed, without regenerating. A container's labels cannot change once it
+// is created, so the package is unchanged as long as the installed copy still
+// carries the recorded hash. Returns false if a full check is needed.
+func (m *Monitor) resumeInstalled(ctx context.Context, containerID string) bool {
+	state, exists := m.containers.get(containerID)
+	var appName, hash string
+	if exists && state.Installed {
+		appName, hash = state.AppName, state.PackageHash
+	}
 
-	if !exists || !state.Installed {
+	if m.installer == nil || hash == "" || hash != m.installer.InstalledPackageHash(appName) {
+		return false
+	}
+
+	slog.InfoContext(ctx, "Tracked app unchanged, starting", "app", appName, "id", containerID)
+	if err := m.queueOperation(ctx, "start", appName, ""); err != nil && !errors.Is(err, ErrOperationSuperseded) {
+		slog.WarnContext(ctx, "Failed to start fnOS app", "app", appName, "error", err)
+		return true
+	}
+
+	resumed := m.containers.update(containerID, func(state *ContainerState) bool {
+		changed := state.Stopped
+		state.Stopped = false
+		return changed
+	})
+	if resumed {
+		m.persistState()
+	}
+	return true
+}
+
+// persistState writes the tracked containers to the state store
+func (m *Monitor) persistState() {
+	if m.store == nil {
 		return
 	}
+	err := m.store.save(m.containers.all)
+	if err != nil {
+		slog.Warn("Failed to save container state", "error", err)
+	}
+}
 
-	// Stop via queue (serialized)
-	if err := m.queueOperation("stop", state.AppName, ""); err != nil {
-		slog.Warn("Failed to stop fnOS app", "app", state.AppName, "error", err)
+// renderPackage renders the package for a container in memory in a generate
+// slot, reusing the inspect result from the event or readiness check.
+// The slot is released before the install is queued, so other containers
+// keep generating while install-local runs.
+func (m *Monitor) renderPackage(ctx context.Context, containerID string) (*fpkgen.Package, error) {
+	waitStart := time.Now()
+	select {
+	case m.generateSlots <- struct{}{}:
+	case <-ctx.Done():
+		return nil, ctx.Err()
 	}
+	defer func() { <-m.generateSlots }()
+	trace.FromContext(ctx).Record("generate_slot_wait", time.Since(waitStart))
+
+	ctx, span := trace.Start(ctx, "generate")
+	done := fpkgen.StartGeneratePhase(ctx, "inspect")
+	info, err := m.inspect.get(ctx, containerID)
+	done(err)
+	if err != nil {
+		span.End(err)
+		return nil, fmt.Errorf("failed to inspect container: %w", err)
+	}
+	pkg, err := m.generator.BuildFromInspect(ctx, &info)
+	span.End(err)
+	return pkg, err
 }
 
-// handleContainerDestroy handles container destroy event (uninstall app)
-func (m *Monitor) handleContainerDestroy(ctx context.Context, containerID, containerName string) {
-	m.mu.RLock()
-	state, exists := m.containers[containerID]
-	m.mu.RUnlock()
+// handleContainerStop handles container stop event (stop app, keep installed);
+// call it on the container's actor
+func (m *Monitor) handleContainerStop(ctx context.Context, containerID, containerName string) {
+	state, exists := m.containers.get(containerID)
 
-	if !exists {
+	if !exists || !state.Installed {
 		return
 	}
 
-	// Uninstall via queue (serialized)
-	if state.Installed {
-		if err := m.queueOperation("uninstall", state.AppName, ""); err != nil {
-			slog.Warn("Failed to uninstall fnOS app", "app", state.AppName, "error", err)
-		}
+	ctx, span := trace.Start(ctx, "container_stop", "container", containerName)
+	defer span.End(nil)
+
+	// Stop via queue (serialized); a superseded stop never ran, and the later
+	// operation that replaced it records its own state
+	if err := m.queueOperation(ctx, "stop", state.AppName, ""); errors.Is(err, ErrOperationSuperseded) {
+		return
+	} else if err != nil {
+		slog.WarnContext(ctx, "Failed to stop fnOS app", "app", state.AppName, "error", err)
+		return
 	}
 
-	// Remove from tracking
-	m.mu.Lock()
-	delete(m.containers, containerID)
-	m.mu.Unlock()
-	m.generator.MarkUninstalled(containerID)
+	m.containers.update(containerID, func(state *ContainerState) bool {
+		state.Stopped = true
+		return true
+	})
+	m.persistState()
 }
 
-// scanContainers scans all running containers
-func (m *Monitor) scanContainers(ctx context.Context) {
-	containers, err := m.cli.ContainerList(ctx, container.ListOptions{})
-	if err != nil {
-		slog.Error("Failed to list containers", "error", err)
+// handleContainerDestroy handles container destroy event (uninstall app);
+// call it on the container's actor
+func (m *Monitor) handleContainerDestroy(ctx context.Context, containerID, containerName string) {
+	state, exists := m.containers.get(containerID)
+
+	if !exists {
 		return
 	}
 
-	slog.Info("Scanning existing containers...", "count", len(containers))
-
-	for _, ctr := range containers {
-		containerID := ctr.ID[:12]
-		containerName := strings.TrimPrefix(ctr.Names[0], "/")
+	ctx, span := trace.Start(ctx, "container_destroy", "container", containerName)
+	defer span.End(nil)
 
-		// Check if should be installed
-		if shouldInstall(ctr.Labels) {
-			slog.Info("Found container to install", "container", containerName)
-			go m.handleContainerStart(ctx, containerID, containerName, ctr.Labels)
+	// Uninstall via queue (serialized)
+	if state.Installed {
+		if err := m.queueOperation(ctx, "uninstall", state.AppName, ""); errors.Is(err, ErrOperationSuperseded) {
+			// A recreated container took the app over before the uninstall ran
+			slog.InfoContext(ctx, "Uninstall superseded, app kept", "app", state.AppName)
+		} else if errors.Is(err, ErrMonitorStopped) {
+			// Stay tracked, so the startup reconcile retries the uninstall
+			return
+		} else if err != nil {
+			// The container is gone either way; the app may need manual removal
+			slog.WarnContext(ctx, "Failed to uninstall fnOS app", "app", state.AppName, "error", err,
+				"hint", "may need manual uninstall from App Center")
+			if m.inventory != nil {
+				m.inventory.Invalidate()
+			}
+		} else if m.inventory != nil {
+			m.inventory.Remove(state.AppName)
 		}
 	}
+
+	// Remove from tracking
+	m.containers.remove(containerID)
+	m.persistState()
 }
 
-// GetContainerStates returns all monitored container states
+// GetContainerStates returns copies of all monitored container states,
+// including the labels the status snapshot leaves out
 func (m *Monitor) GetContainerStates() map[string]*ContainerState {
-	m.mu.RLock()
-	defer m.mu.RUnlock()
-
-	result := make(map[string]*ContainerState)
-	for k, v := range m.containers {
-		result[k] = v
-	}
-	return result
+	return m.containers.all()
 }
 
 // Stop stops the monitor
 func (m *Monitor) Stop() {
 	close(m.stopCh)
 
+	// Let the worker kill an in-flight appcenter-cli before we exit
+	if m.workerStarted.Load() {
+		select {
+		case <-m.workerDone:
+		case <-time.After(stopWorkerTimeout):
+			slog.Warn("Operation worker did not stop in time")
+		}
+	}
+
 	if m.generator != nil {
 		m.generator.Close()
 	}
 
+	if m.status != nil {
+		m.status.Close()
+	}
+
 	if m.cli != nil {
 		if err := m.cli.Close(); err != nil {
 			slog.Warn("Error closing Docker client", "error", err)
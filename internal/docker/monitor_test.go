@@ -0,0 +1,240 @@
+package docker
+
+import (
+	"context"
+	"errors"
+	"image"
+	"image/png"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+
+	"github.com/docker/docker/api/types/container"
+	"github.com/docker/docker/client"
+
+	"watchcow/internal/fpkgen"
+)
+
+// fakeInstaller records calls and reports a fixed set of installed apps
+type fakeInstaller struct {
+	mu     sync.Mutex
+	calls  []string
+	hashes map[string]string // map[appName]installed package hash
+	errs   map[string]error  // map[call]error it returns
+}
+
+func (f *fakeInstaller) record(call string) error {
+	f.mu.Lock()
+	defer f.mu.Unlock()
+	f.calls = append(f.calls, call)
+	return f.errs[call]
+}
+
+func (f *fakeInstaller) Calls() []string {
+	f.mu.Lock()
+	defer f.mu.Unlock()
+	return append([]string(nil), f.calls...)
+}
+
+func (f *fakeInstaller) InstallLocal(ctx context.Context, appDir string) error {
+	return f.record("install-local")
+}
+func (f *fakeInstaller) Uninstall(ctx context.Context, appName string) error {
+	return f.record("uninstall " + appName)
+}
+func (f *fakeInstaller) StartApp(ctx context.Context, appName string) error {
+	return f.record("start " + appName)
+}
+func (f *fakeInstaller) StopApp(ctx context.Context, appName string) error {
+	return f.record("stop " + appName)
+}
+func (f *fakeInstaller) SupportsBatch(op string) bool { return false }
+func (f *fakeInstaller) StartApps(ctx context.Context, appNames []string) []error {
+	return make([]error, len(appNames))
+}
+func (f *fakeInstaller) StopApps(ctx context.Context, appNames []string) []error {
+	return make([]error, len(appNames))
+}
+func (f *fakeInstaller) UninstallApps(ctx context.Context, appNames []string) []error {
+	return make([]error, len(appNames))
+}
+func (f *fakeInstaller) ListInstalledApps(ctx context.Context) ([]string, error) {
+	f.mu.Lock()
+	defer f.mu.Unlock()
+	var names []string
+	for name := range f.hashes {
+		names = append(names, name)
+	}
+	return names, nil
+}
+func (f *fakeInstaller) InstalledPackageHash(appName string) string {
+	f.mu.Lock()
+	defer f.mu.Unlock()
+	return f.hashes[appName]
+}
+
+// newFlowMonitor returns a Monitor that generates real packages for the
+// given inspect results and runs operations on installer
+func newFlowMonitor(t *testing.T, installer *fakeInstaller, containers map[string]container.InspectResponse) *Monitor {
+	t.Helper()
+	generator, err := fpkgen.NewGenerator(fpkgen.WithDockerClient(&client.Client{}))
+	if err != nil {
+		t.Fatalf("NewGenerator failed: %v", err)
+	}
+	m := &Monitor{
+		inspect: newInspectCache(time.Minute, func(ctx context.Context, id string) (container.InspectResponse, error) {
+			return containers[id], nil
+		}),
+		generator:     generator,
+		installer:     installer,
+		inventory:     fpkgen.NewAppInventory(installer),
+		stopCh:        make(chan struct{}),
+		actors:        newActors(),
+		ops:           newOpScheduler(),
+		workerDone:    make(chan struct{}),
+		batchWindow:   -1,
+		generateSlots: make(chan struct{}, 1),
+		readyTimeout:  time.Second,
+	}
+	m.containers = newContainerTable(m.publishSnapshot)
+	return m
+}
+
+// isClosed reports whether done is closed, without blocking
+func isClosed(done <-chan struct{}) bool {
+	select {
+	case <-done:
+		return true
+	default:
+		return false
+	}
+}
+
+// runningContainer returns the inspect result of a running managed container
+func runningContainer(id, name string, labels map[string]string) container.InspectResponse {
+	return container.InspectResponse{
+		ContainerJSONBase: &container.ContainerJSONBase{
+			ID:         id,
+			Name:       "/" + name,
+			State:      &container.State{Status: "running", Running: true},
+			HostConfig: &container.HostConfig{},
+		},
+		Config:          &container.Config{Image: "nginx:latest", Labels: labels},
+		NetworkSettings: &container.NetworkSettings{},
+	}
+}
+
+// TestRecreate_KeepsInstalledApp tests that destroying a container and
+// starting an identical replacement (docker compose up --force-recreate)
+// only starts the installed app instead of uninstalling and reinstalling it
+func TestRecreate_KeepsInstalledApp(t *testing.T) {
+	iconPath := filepath.Join(t.TempDir(), "icon.png")
+	f, _ := os.Create(iconPath)
+	png.Encode(f, image.NewRGBA(image.Rect(0, 0, 64, 64)))
+	f.Close()
+	labels := map[string]string{"watchcow.enable": "true", "watchcow.icon": "file://" + iconPath}
+
+	const oldID, newID = "aaaaaaaaaaaa0000", "bbbbbbbbbbbb0000"
+	containers := map[string]container.InspectResponse{
+		oldID: runningContainer(oldID, "web", labels),
+		newID: runningContainer(newID, "web", labels),
+	}
+	installer := &fakeInstaller{hashes: map[string]string{}}
+	m := newFlowMonitor(t, installer, containers)
+	m.ops.uninstallDelay = time.Minute
+	ctx, cancel := context.WithCancel(context.Background())
+	defer cancel()
+	m.workerStarted.Store(true)
+	go m.runOperationWorker(ctx)
+	defer close(m.stopCh)
+
+	// The old container's package is installed and tracked
+	pkg, err := m.renderPackage(ctx, oldID)
+	if err != nil {
+		t.Fatalf("renderPackage failed: %v", err)
+	}
+	appName := pkg.Config.AppName
+	installer.hashes[appName] = pkg.Config.PackageHash
+	m.containers.put(ContainerState{ContainerID: oldID, ContainerName: "web", AppName: appName, Installed: true, PackageHash: pkg.Config.PackageHash})
+
+	// destroy(old) -> create/start(new), each on its container's actor
+	destroyed := m.actors.submit(oldID, func() { m.handleContainerDestroy(ctx, oldID, "web") })
+	for m.ops.Len() == 0 && !isClosed(destroyed) {
+		time.Sleep(time.Millisecond)
+	}
+	started := m.actors.submit(newID, func() { m.handleContainerStart(ctx, newID, "web", labels) })
+
+	for _, done := range []<-chan struct{}{started, destroyed} {
+		select {
+		case <-done:
+		case <-time.After(5 * time.Second):
+			t.Fatal("recreate did not finish")
+		}
+	}
+
+	if calls := installer.Calls(); strings.Join(calls, ",") != "start "+appName {
+		t.Errorf("installer calls = %v, want only a start", calls)
+	}
+	if !m.inventory.Has(ctx, appName) {
+		t.Error("app dropped from the inventory")
+	}
+	if state, ok := m.containers.get(newID); !ok || !state.Installed {
+		t.Errorf("new container state = %+v, want installed", state)
+	}
+	if _, ok := m.containers.get(oldID); ok {
+		t.Error("old container still tracked")
+	}
+}
+
+// TestStop_SupersededKeepsRunning tests that a stop replaced by a later start
+// does not record the container as stopped
+func TestStop_SupersededKeepsRunning(t *testing.T) {
+	m := newFlowMonitor(t, &fakeInstaller{}, nil)
+	ctx := context.Background()
+	m.containers.put(ContainerState{ContainerID: "aaaaaaaaaaaa", ContainerName: "web", AppName: "watchcow.web", Installed: true})
+
+	// No worker runs, so the stop is still queued when the start arrives
+	stopped := m.actors.submit("aaaaaaaaaaaa", func() { m.handleContainerStop(ctx, "aaaaaaaaaaaa", "web") })
+	for m.ops.Len() == 0 {
+		time.Sleep(time.Millisecond)
+	}
+	go m.queueOperation(ctx, "start", "watchcow.web", "")
+	select {
+	case <-stopped:
+	case <-time.After(5 * time.Second):
+		t.Fatal("superseded stop did not return")
+	}
+	m.ops.close(ErrMonitorStopped)
+
+	if state, _ := m.containers.get("aaaaaaaaaaaa"); state.Stopped {
+		t.Error("container marked stopped by a stop that never ran")
+	}
+}
+
+// TestDestroy_UninstallFailureInvalidatesInventory tests that a failed
+// uninstall re-reads the inventory instead of dropping the app from it, and
+// still drops the container
+func TestDestroy_UninstallFailureInvalidatesInventory(t *testing.T) {
+	installer := &fakeInstaller{errs: map[string]error{"uninstall watchcow.web": errors.New("cli failed")}}
+	m := newFlowMonitor(t, installer, nil)
+	ctx, cancel := context.WithCancel(context.Background())
+	defer cancel()
+	m.workerStarted.Store(true)
+	go m.runOperationWorker(ctx)
+	defer close(m.stopCh)
+
+	installer.hashes = map[string]string{"watchcow.web": ""} // Still installed after the failure
+	m.inventory.Refresh(ctx)
+	m.containers.put(ContainerState{ContainerID: "aaaaaaaaaaaa", ContainerName: "web", AppName: "watchcow.web", Installed: true})
+	<-m.actors.submit("aaaaaaaaaaaa", func() { m.handleContainerDestroy(ctx, "aaaaaaaaaaaa", "web") })
+
+	if _, ok := m.containers.get("aaaaaaaaaaaa"); ok {
+		t.Error("destroyed container still tracked")
+	}
+	if !m.inventory.Has(ctx, "watchcow.web") {
+		t.Error("failed uninstall recorded as removed instead of re-reading the inventory")
+	}
+}
@@ -0,0 +1,122 @@
+package docker
+
+import (
+	"context"
+	"fmt"
+	"log/slog"
+	"net"
+	"strings"
+	"time"
+
+	"github.com/docker/docker/api/types/container"
+)
+
+const (
+	// DefaultReadyTimeout bounds how long generation waits for a container to become ready
+	DefaultReadyTimeout = 30 * time.Second
+
+	// readyPollInterval is the delay between readiness inspections
+	readyPollInterval = 250 * time.Millisecond
+
+	// readyProbeTimeout bounds a single connection attempt to a published port
+	readyProbeTimeout = 200 * time.Millisecond
+)
+
+// containerReady reports whether an inspected container is ready for packaging:
+// healthy when it has a healthcheck, otherwise a published TCP port accepts
+// connections. Docker fills in the host ports as soon as the container starts,
+// so the bindings alone say nothing about the service behind them.
+// Returns an error if the container is no longer running.
+func containerReady(ctx context.Context, info *container.InspectResponse, probe func(ctx context.Context, address string) bool) (bool, error) {
+	if info.ContainerJSONBase == nil || info.State == nil || !info.State.Running {
+		return false, fmt.Errorf("container is not running")
+	}
+
+	if health := info.State.Health; health != nil {
+		// Unhealthy may still recover; the ready timeout bounds the wait
+		return health.Status == "healthy", nil
+	}
+
+	if info.HostConfig == nil || len(info.HostConfig.PortBindings) == 0 {
+		return true, nil
+	}
+	if info.NetworkSettings == nil {
+		return false, nil
+	}
+	probed, udpBound := false, false
+	for port, bindings := range info.NetworkSettings.Ports {
+		udp := strings.HasSuffix(string(port), "/udp")
+		for _, binding := range bindings {
+			if binding.HostPort == "" {
+				continue
+			}
+			if udp {
+				udpBound = true
+				continue
+			}
+			probed = true
+			if probe(ctx, net.JoinHostPort(probeHost(binding.HostIP), binding.HostPort)) {
+				return true, nil
+			}
+		}
+	}
+	// UDP cannot be probed, so UDP-only containers are ready once bound
+	return !probed && udpBound, nil
+}
+
+// probeHost returns the address to dial for a port published on hostIP,
+// using loopback for the wildcard addresses
+func probeHost(hostIP string) string {
+	switch hostIP {
+	case "", "0.0.0.0", "::":
+		return "127.0.0.1"
+	}
+	return hostIP
+}
+
+// probePort reports whether a TCP connection to address succeeds
+func probePort(ctx context.Context, address string) bool {
+	dialer := net.Dialer{Timeout: readyProbeTimeout}
+	conn, err := dialer.DialContext(ctx, "tcp", address)
+	if err != nil {
+		return false
+	}
+	conn.Close()
+	return true
+}
+
+// waitContainerReady polls the container until containerReady holds.
+// On timeout it logs and returns nil so generation proceeds with what is known.
+func (m *Monitor) waitContainerReady(ctx context.Context, containerID string) error {
+	deadline := time.Now().Add(m.readyTimeout)
+	ticker := time.NewTicker(readyPollInterval)
+	defer ticker.Stop()
+
+	// The first check may reuse the inspect done for the start event
+	inspect := m.inspect.get
+	for {
+		info, err := inspect(ctx, containerID)
+		if err != nil {
+			return fmt.Errorf("failed to inspect container: %w", err)
+		}
+		ready, err := containerReady(ctx, &info, probePort)
+		if err != nil {
+			return err
+		}
+		if ready {
+			return nil
+		}
+		if time.Now().After(deadline) {
+			slog.Warn("Container not ready before timeout, generating anyway",
+				"id", containerID, "timeout", m.readyTimeout)
+			return nil
+		}
+
+		select {
+		case <-ctx.Done():
+			return ctx.Err()
+		case <-ticker.C:
+		}
+		inspect = m.inspect.refresh // Later checks need fresh state
+	}
+}
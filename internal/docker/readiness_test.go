@@ -0,0 +1,76 @@
+package docker
+
+import (
+	"context"
+	"net"
+	"testing"
+
+	"github.com/docker/docker/api/types/container"
+	"github.com/docker/go-connections/nat"
+)
+
+// inspectWith builds an inspect response with the given state and published ports
+func inspectWith(state *container.State, bindings nat.PortMap) *container.InspectResponse {
+	return &container.InspectResponse{
+		ContainerJSONBase: &container.ContainerJSONBase{
+			State:      state,
+			HostConfig: &container.HostConfig{PortBindings: bindings},
+		},
+		NetworkSettings: &container.NetworkSettings{},
+	}
+}
+
+// TestContainerReady tests readiness for healthchecked, port-publishing and plain containers
+func TestContainerReady(t *testing.T) {
+	published := nat.PortMap{"80/tcp": {{HostPort: "8080"}}}
+	udp := nat.PortMap{"53/udp": {{HostPort: "5353"}}}
+	listening := func(ctx context.Context, address string) bool { return address == "127.0.0.1:8080" }
+	closed := func(ctx context.Context, address string) bool { return false }
+
+	cases := []struct {
+		name    string
+		info    *container.InspectResponse
+		bound   nat.PortMap
+		probe   func(ctx context.Context, address string) bool
+		ready   bool
+		wantErr bool
+	}{
+		{"not running", inspectWith(&container.State{Running: false}, nil), nil, listening, false, true},
+		{"health starting", inspectWith(&container.State{Running: true, Health: &container.Health{Status: "starting"}}, published), published, listening, false, false},
+		{"unhealthy", inspectWith(&container.State{Running: true, Health: &container.Health{Status: "unhealthy"}}, published), published, listening, false, false},
+		{"healthy", inspectWith(&container.State{Running: true, Health: &container.Health{Status: "healthy"}}, published), nil, closed, true, false},
+		{"no published ports", inspectWith(&container.State{Running: true}, nil), nil, closed, true, false},
+		{"ports not bound yet", inspectWith(&container.State{Running: true}, published), nil, listening, false, false},
+		{"ports bound, not listening", inspectWith(&container.State{Running: true}, published), published, closed, false, false},
+		{"ports bound and listening", inspectWith(&container.State{Running: true}, published), published, listening, true, false},
+		{"udp only", inspectWith(&container.State{Running: true}, udp), udp, closed, true, false},
+	}
+
+	for _, tc := range cases {
+		tc.info.NetworkSettings.Ports = tc.bound
+		ready, err := containerReady(context.Background(), tc.info, tc.probe)
+		if (err != nil) != tc.wantErr {
+			t.Errorf("%s: unexpected error %v", tc.name, err)
+		}
+		if ready != tc.ready {
+			t.Errorf("%s: expected ready=%v, got %v", tc.name, tc.ready, ready)
+		}
+	}
+}
+
+// TestProbePort tests the TCP probe against a listening and a closed port
+func TestProbePort(t *testing.T) {
+	ln, err := net.Listen("tcp", "127.0.0.1:0")
+	if err != nil {
+		t.Fatalf("Listen failed: %v", err)
+	}
+	address := ln.Addr().String()
+
+	if !probePort(context.Background(), address) {
+		t.Error("probe failed against a listening port")
+	}
+	ln.Close()
+	if probePort(context.Background(), address) {
+		t.Error("probe succeeded against a closed port")
+	}
+}
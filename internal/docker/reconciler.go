@@ -0,0 +1,160 @@
+package docker
+
+import (
+	"context"
+	"log/slog"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/docker/docker/api/types/container"
+)
+
+// DefaultReconcileInterval is how often tracked state is diffed against Docker
+const DefaultReconcileInterval = 5 * time.Minute
+
+// reconcileTarget identifies a container an action applies to
+type reconcileTarget struct {
+	ContainerID   string
+	ContainerName string
+	Labels        map[string]string
+}
+
+// reconcilePlan is the set of actions that converges tracked state with Docker
+type reconcilePlan struct {
+	Start     []reconcileTarget // Running labelled containers whose app is not known to be running
+	Stop      []reconcileTarget // Tracked containers that exist but are no longer running
+	Uninstall []reconcileTarget // Tracked containers that no longer exist
+}
+
+// planReconcile diffs the Docker container list (including stopped containers)
+// against tracked state. With initial set, every running labelled container is
+// started, since app run state from before a restart is unknown.
+func planReconcile(list []container.Summary, tracked map[string]*ContainerState, initial bool) reconcilePlan {
+	var plan reconcilePlan
+	seen := make(map[string]bool, len(list))
+
+	for _, ctr := range list {
+		id := shortID(ctr.ID)
+		seen[id] = true
+		state := tracked[id]
+
+		name := ""
+		if len(ctr.Names) > 0 {
+			name = strings.TrimPrefix(ctr.Names[0], "/")
+		}
+		target := reconcileTarget{ContainerID: id, ContainerName: name, Labels: ctr.Labels}
+
+		if ctr.State == "running" {
+			if !shouldInstall(ctr.Labels) {
+				continue
+			}
+			if initial || state == nil || !state.Installed || state.Stopped {
+				plan.Start = append(plan.Start, target)
+			}
+		} else if state != nil && state.Installed && !state.Stopped {
+			plan.Stop = append(plan.Stop, target)
+		}
+	}
+
+	for id, state := range tracked {
+		if !seen[id] {
+			plan.Uninstall = append(plan.Uninstall, reconcileTarget{ContainerID: id, ContainerName: state.ContainerName})
+		}
+	}
+
+	return plan
+}
+
+// runReconciler reconciles once at startup, then on every interval tick and
+// whenever requestReconcile is called (e.g. after the event stream reconnects)
+func (m *Monitor) runReconciler(ctx context.Context) {
+	m.reconcile(ctx, true)
+
+	ticker := time.NewTicker(m.reconcileInterval)
+	defer ticker.Stop()
+
+	for {
+		select {
+		case <-ctx.Done():
+			return
+		case <-m.stopCh:
+			return
+		case <-ticker.C:
+		case <-m.reconcileCh:
+		}
+		m.reconcile(ctx, false)
+	}
+}
+
+// requestReconcile schedules a reconcile pass without blocking
+func (m *Monitor) requestReconcile() {
+	select {
+	case m.reconcileCh <- struct{}{}:
+	default:
+	}
+}
+
+// reconcile lists containers once, plans the actions and runs them with
+// bounded concurrency. Operations still go through the scheduler, which
+// collapses them with anything queued by concurrent events.
+func (m *Monitor) reconcile(ctx context.Context, initial bool) {
+	start := time.Now()
+	list, err := m.cli.ContainerList(ctx, container.ListOptions{All: true, Filters: containerListFilters(m.watchAll)})
+	observeDockerCall("list", start)
+	if err != nil {
+		slog.Error("Failed to list containers", "error", err)
+		return
+	}
+
+	m.syncStatus(list, start)
+
+	plan := planReconcile(list, m.containers.all(), initial)
+
+	if len(plan.Start)+len(plan.Stop)+len(plan.Uninstall) == 0 {
+		slog.Debug("Reconcile found nothing to do", "containers", len(list))
+		return
+	}
+	slog.Info("Reconciling containers", "containers", len(list),
+		"start", len(plan.Start), "stop", len(plan.Stop), "uninstall", len(plan.Uninstall))
+
+	jobs := make(chan func())
+	var wg sync.WaitGroup
+	for i := 0; i < cap(m.generateSlots); i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for job := range jobs {
+				job()
+			}
+		}()
+	}
+
+	// Each job runs on its container's actor, ordered with concurrent events
+	for _, t := range plan.Uninstall {
+		jobs <- func() {
+			<-m.actors.submit(t.ContainerID, func() {
+				m.coalescer.settle(t.ContainerID, stateDestroyed)
+				m.handleContainerDestroy(ctx, t.ContainerID, t.ContainerName)
+			})
+		}
+	}
+	for _, t := range plan.Stop {
+		jobs <- func() {
+			<-m.actors.submit(t.ContainerID, func() {
+				m.coalescer.settle(t.ContainerID, stateStopped)
+				m.handleContainerStop(ctx, t.ContainerID, t.ContainerName)
+			})
+		}
+	}
+	for _, t := range plan.Start {
+		jobs <- func() {
+			<-m.actors.submit(t.ContainerID, func() {
+				m.coalescer.settle(t.ContainerID, stateRunning)
+				m.handleContainerStart(ctx, t.ContainerID, t.ContainerName, t.Labels)
+			})
+		}
+	}
+	close(jobs)
+	wg.Wait()
+}
@@ -0,0 +1,141 @@
+package docker
+
+import (
+	"os"
+	"path/filepath"
+	"sort"
+	"testing"
+	"time"
+
+	"github.com/docker/docker/api/types/container"
+	"github.com/docker/docker/api/types/events"
+	"github.com/docker/docker/api/types/filters"
+
+	"watchcow/internal/fpkgen"
+)
+
+var enabledLabels = map[string]string{"watchcow.enable": "true"}
+
+func targetIDs(targets []reconcileTarget) []string {
+	ids := make([]string, 0, len(targets))
+	for _, t := range targets {
+		ids = append(ids, t.ContainerID)
+	}
+	sort.Strings(ids)
+	return ids
+}
+
+func equalIDs(a, b []string) bool {
+	if len(a) != len(b) {
+		return false
+	}
+	for i := range a {
+		if a[i] != b[i] {
+			return false
+		}
+	}
+	return true
+}
+
+// TestPlanReconcile tests the start/stop/uninstall sets computed from a container list
+func TestPlanReconcile(t *testing.T) {
+	list := []container.Summary{
+		{ID: "aaaaaaaaaaaa0000", Names: []string{"/new"}, State: "running", Labels: enabledLabels},
+		{ID: "bbbbbbbbbbbb0000", Names: []string{"/steady"}, State: "running", Labels: enabledLabels},
+		{ID: "cccccccccccc0000", Names: []string{"/exited"}, State: "exited", Labels: enabledLabels},
+		{ID: "dddddddddddd0000", Names: []string{"/resumed"}, State: "running", Labels: enabledLabels},
+		{ID: "eeeeeeeeeeee0000", Names: []string{"/unlabelled"}, State: "running"},
+	}
+	tracked := map[string]*ContainerState{
+		"bbbbbbbbbbbb": {AppName: "watchcow.steady", Installed: true},
+		"cccccccccccc": {AppName: "watchcow.exited", Installed: true},
+		"dddddddddddd": {AppName: "watchcow.resumed", Installed: true, Stopped: true},
+		"ffffffffffff": {AppName: "watchcow.gone", ContainerName: "gone", Installed: true},
+	}
+
+	plan := planReconcile(list, tracked, false)
+	if got := targetIDs(plan.Start); !equalIDs(got, []string{"aaaaaaaaaaaa", "dddddddddddd"}) {
+		t.Errorf("unexpected start set %v", got)
+	}
+	if got := targetIDs(plan.Stop); !equalIDs(got, []string{"cccccccccccc"}) {
+		t.Errorf("unexpected stop set %v", got)
+	}
+	if got := targetIDs(plan.Uninstall); !equalIDs(got, []string{"ffffffffffff"}) {
+		t.Errorf("unexpected uninstall set %v", got)
+	}
+
+	// The initial pass also starts apps that were running before a restart
+	plan = planReconcile(list, tracked, true)
+	if got := targetIDs(plan.Start); !equalIDs(got, []string{"aaaaaaaaaaaa", "bbbbbbbbbbbb", "dddddddddddd"}) {
+		t.Errorf("unexpected initial start set %v", got)
+	}
+}
+
+// TestContainerStatuses tests the status file contents derived from a list
+func TestContainerStatuses(t *testing.T) {
+	list := []container.Summary{
+		{Names: []string{"/web"}, State: "running", Labels: enabledLabels},
+		{Names: []string{"/db"}, State: "exited", Labels: enabledLabels},
+		{Names: []string{"/other"}, State: "running"},
+	}
+	got := containerStatuses(list)
+	if len(got) != 2 || !got["web"] || got["db"] {
+		t.Errorf("containerStatuses() = %v", got)
+	}
+}
+
+// TestSyncStatus_KeepsNewerEvents tests that a reconcile list does not
+// overwrite a status file an event wrote after the list was taken
+func TestSyncStatus_KeepsNewerEvents(t *testing.T) {
+	dir := t.TempDir()
+	status, err := fpkgen.OpenStatusFiles(dir)
+	if err != nil {
+		t.Fatalf("OpenStatusFiles failed: %v", err)
+	}
+	m := &Monitor{status: status}
+	listedAt := time.Now()
+	list := []container.Summary{
+		{Names: []string{"/web"}, State: "exited", Labels: enabledLabels},
+		{Names: []string{"/db"}, State: "exited", Labels: enabledLabels},
+	}
+
+	// web started after the list was taken
+	m.publishStatus(events.Message{Action: "start", Actor: events.Actor{
+		Attributes: map[string]string{"name": "web", "watchcow.enable": "true"},
+	}})
+	m.syncStatus(list, listedAt)
+
+	read := func(name string) string {
+		data, _ := os.ReadFile(filepath.Join(dir, name))
+		return string(data)
+	}
+	if read("web") != "running\n" || read("db") != "stopped\n" {
+		t.Errorf("web=%q db=%q, want running and stopped", read("web"), read("db"))
+	}
+
+	// A later list supersedes the event
+	m.syncStatus(list, time.Now())
+	if read("web") != "stopped\n" {
+		t.Errorf("web=%q after a newer list, want stopped", read("web"))
+	}
+}
+
+// TestContainerFilters tests the server-side label filters and watch-all mode
+func TestContainerFilters(t *testing.T) {
+	hasLabel := func(args filters.Args) bool {
+		labels := args.Get("label")
+		return len(labels) == 1 && labels[0] == managedLabel
+	}
+
+	events := containerEventFilters(false)
+	if !hasLabel(events) || len(events.Get("event")) != 4 {
+		t.Errorf("event filters = %v", events)
+	}
+	if !hasLabel(containerListFilters(false)) {
+		t.Error("list filters lack the label filter")
+	}
+
+	if len(containerEventFilters(true).Get("label")) != 0 || containerListFilters(true).Len() != 0 {
+		t.Error("watch-all mode should not filter by label")
+	}
+}
@@ -0,0 +1,455 @@
+package docker
+
+import (
+	"context"
+	"errors"
+	"log/slog"
+	"os"
+	"sort"
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// ErrOperationSuperseded is returned to callers whose queued operation was
+// dropped because a later operation for the same app made it redundant
+var ErrOperationSuperseded = errors.New("operation superseded by a later request")
+
+// ErrMonitorStopped is returned to callers whose queued operation never ran
+// because the operation worker stopped
+var ErrMonitorStopped = errors.New("monitor stopped before the operation ran")
+
+// starvationAge is how long a runnable operation may wait before it goes
+// ahead of higher-priority types, so a steady stream of start/stop ops
+// cannot hold back installs indefinitely
+const starvationAge = 10 * time.Second
+
+// opPriority orders operations across apps: cheap run-state changes first,
+// slow install-local runs last
+type opPriority int
+
+const (
+	priorityInstall opPriority = iota
+	priorityUninstall
+	priorityRun
+)
+
+// priorityFor returns the scheduling priority of an operation type
+func priorityFor(opType string) opPriority {
+	switch opType {
+	case "start", "stop":
+		return priorityRun
+	case "uninstall":
+		return priorityUninstall
+	}
+	return priorityInstall
+}
+
+// isRunOp reports whether an operation only changes the run state of an app
+func isRunOp(opType string) bool {
+	return opType == "start" || opType == "stop"
+}
+
+// scheduledOp is a queued operation plus every caller waiting on its result
+type scheduledOp struct {
+	*AppOperation
+	seq       uint64
+	queuedAt  time.Time
+	notBefore time.Time // Held until then (uninstalls, see uninstallDelay)
+	waiters   []chan error
+}
+
+// runnableSince returns when the operation became eligible to run
+func (s *scheduledOp) runnableSince() time.Time {
+	if s.notBefore.After(s.queuedAt) {
+		return s.notBefore
+	}
+	return s.queuedAt
+}
+
+// describe returns the public view of the operation
+func (s *scheduledOp) describe() QueuedOperation {
+	return QueuedOperation{Type: s.Type, AppName: s.AppName, QueuedAt: s.queuedAt}
+}
+
+// complete delivers the result to all waiters (result channels are buffered)
+func (s *scheduledOp) complete(err error) {
+	for _, ch := range s.waiters {
+		if ch != nil {
+			ch <- err
+		}
+	}
+}
+
+// opScheduler is a keyed queue of appcenter-cli operations.
+//
+// Operations for the same app run in submission order, and redundant ones are
+// collapsed on push: a newer start/stop replaces a pending one, a newer
+// install/upgrade replaces a pending one, and an uninstall cancels a pending
+// install outright. Uninstalls are held for uninstallDelay, and a start or
+// install that arrives meanwhile supersedes them: that is a recreated
+// container (docker compose up --force-recreate) taking over the app.
+// Across apps, the next operation is the highest-priority runnable head of
+// any app's queue, FIFO within a priority; operations runnable for longer
+// than starvationAge go first, oldest first. push never blocks; after close it
+// completes operations with the close error instead of queueing them.
+type opScheduler struct {
+	mu      sync.Mutex
+	seq     uint64
+	pending map[string][]*scheduledOp // map[appName]operations in submission order
+	size    int
+	ready   chan struct{}
+	view    atomic.Pointer[[]QueuedOperation] // Queue contents for Snapshot, nil after a change
+	closed  error                             // Set by close; later pushes fail with it
+
+	uninstallDelay time.Duration // How long a queued uninstall waits before it may run
+}
+
+// newOpScheduler creates an empty scheduler
+func newOpScheduler() *opScheduler {
+	return &opScheduler{
+		pending: make(map[string][]*scheduledOp),
+		ready:   make(chan struct{}, 1),
+	}
+}
+
+// push queues an operation, collapsing it with pending operations for the same app
+func (s *opScheduler) push(op *AppOperation) {
+	s.mu.Lock()
+	if err := s.closed; err != nil {
+		s.mu.Unlock()
+		if op.AppDir != "" {
+			os.RemoveAll(op.AppDir)
+		}
+		if op.ResultCh != nil {
+			op.ResultCh <- err
+		}
+		return
+	}
+	s.seq++
+	next := &scheduledOp{AppOperation: op, seq: s.seq, queuedAt: time.Now(), waiters: []chan error{op.ResultCh}}
+	queue := s.pending[op.AppName]
+
+	var dropped []*scheduledOp
+	last := func() *scheduledOp {
+		if len(queue) == 0 {
+			return nil
+		}
+		return queue[len(queue)-1]
+	}
+	dropLast := func() {
+		dropped = append(dropped, queue[len(queue)-1])
+		queue = queue[:len(queue)-1]
+		s.size--
+	}
+
+	enqueue := true
+	switch {
+	case isRunOp(op.Type):
+		if prev := last(); prev != nil && isRunOp(prev.Type) {
+			if prev.Type == op.Type {
+				// Same request already pending: share its result
+				prev.waiters = append(prev.waiters, next.waiters...)
+				enqueue = false
+			} else {
+				dropLast()
+			}
+		} else if prev != nil && prev.Type == "uninstall" && op.Type == "start" {
+			// A new container starts the unchanged app: keep it installed
+			dropLast()
+		}
+
+	case op.Type == "uninstall":
+		// Uninstalling stops the app, so pending run-state changes are moot
+		for prev := last(); prev != nil && isRunOp(prev.Type); prev = last() {
+			dropLast()
+		}
+		if prev := last(); prev != nil && prev.Type == "upgrade" {
+			// The app is installed either way; only the uninstall matters
+			dropLast()
+			if prev := last(); prev != nil && prev.Type == "uninstall" {
+				prev.waiters = append(prev.waiters, next.waiters...)
+				enqueue = false
+			}
+		} else if prev != nil && prev.Type == "install" {
+			// Install followed by uninstall has no net effect
+			dropLast()
+			enqueue = false
+			if prev := last(); prev != nil && prev.Type == "uninstall" {
+				prev.waiters = append(prev.waiters, next.waiters...)
+			} else {
+				defer next.complete(nil)
+			}
+		} else if prev != nil && prev.Type == "uninstall" {
+			prev.waiters = append(prev.waiters, next.waiters...)
+			enqueue = false
+		}
+
+	case op.Type == "install" || op.Type == "upgrade":
+		// The newest package wins; a pending upgrade means the app is installed
+		if prev := last(); prev != nil && (prev.Type == "install" || prev.Type == "upgrade") {
+			if prev.Type == "upgrade" {
+				op.Type = "upgrade"
+			}
+			dropLast()
+		}
+		if prev := last(); prev != nil && prev.Type == "uninstall" {
+			// Not uninstalled yet: replace the installed app in one step
+			op.Type = "upgrade"
+			dropLast()
+		}
+	}
+
+	if enqueue {
+		if op.Type == "uninstall" {
+			next.notBefore = next.queuedAt.Add(s.uninstallDelay)
+		}
+		queue = append(queue, next)
+		s.size++
+	}
+	if len(queue) == 0 {
+		delete(s.pending, op.AppName)
+	} else {
+		s.pending[op.AppName] = queue
+	}
+	depth := s.size
+	queueDepth.Set(float64(depth))
+	s.invalidate()
+	s.mu.Unlock()
+
+	for _, d := range dropped {
+		slog.Debug("Dropped superseded operation", "app", d.AppName, "op", d.Type, "by", op.Type)
+		if d.AppDir != "" {
+			os.RemoveAll(d.AppDir)
+		}
+		d.complete(ErrOperationSuperseded)
+	}
+	slog.Debug("Queued operation", "app", op.AppName, "op", op.Type, "depth", depth)
+
+	select {
+	case s.ready <- struct{}{}:
+	default:
+	}
+}
+
+// pop blocks until an operation is available or ctx/stop is done
+func (s *opScheduler) pop(ctx context.Context, stop <-chan struct{}) (*scheduledOp, bool) {
+	for {
+		s.mu.Lock()
+		op, held := s.takeNext(time.Now())
+		s.mu.Unlock()
+		if op != nil {
+			return op, true
+		}
+
+		if !s.wait(ctx, stop, held) {
+			return nil, false
+		}
+	}
+}
+
+// wait blocks until an operation is pushed, a held one is due after held
+// (0 = no timeout) or ctx/stop is done; it reports false in the last case
+func (s *opScheduler) wait(ctx context.Context, stop <-chan struct{}, held time.Duration) bool {
+	var release <-chan time.Time
+	if held > 0 {
+		timer := time.NewTimer(held)
+		defer timer.Stop()
+		release = timer.C
+	}
+	select {
+	case <-ctx.Done():
+		return false
+	case <-stop:
+		return false
+	case <-s.ready:
+	case <-release:
+	}
+	return true
+}
+
+// popBatch pops the next operation like pop. If it is of a type batchable
+// accepts, runnable operations of the same type for other apps are added, up
+// to max. If any were, it waits at most window for more of the burst to
+// arrive; a lone operation returns at once. Per-app order is kept: only
+// queue heads are taken.
+func (s *opScheduler) popBatch(ctx context.Context, stop <-chan struct{}, batchable func(opType string) bool, window time.Duration, max int) ([]*scheduledOp, bool) {
+	first, ok := s.pop(ctx, stop)
+	if !ok {
+		return nil, false
+	}
+	batch := []*scheduledOp{first}
+	if max < 2 || !batchable(first.Type) {
+		return batch, true
+	}
+
+	s.mu.Lock()
+	batch = s.takeSameType(batch, first.Type, max)
+	s.mu.Unlock()
+	if len(batch) == 1 {
+		return batch, true // Nothing to batch with, so no burst to wait for
+	}
+
+	timer := time.NewTimer(window)
+	defer timer.Stop()
+	for {
+		if len(batch) >= max {
+			return batch, true
+		}
+
+		select {
+		case <-ctx.Done():
+			return batch, true
+		case <-stop:
+			return batch, true
+		case <-timer.C:
+			return batch, true
+		case <-s.ready:
+		}
+		s.mu.Lock()
+		batch = s.takeSameType(batch, first.Type, max)
+		s.mu.Unlock()
+	}
+}
+
+// takeSameType appends runnable opType heads to batch, oldest first, until it
+// holds max operations; caller holds mu
+func (s *opScheduler) takeSameType(batch []*scheduledOp, opType string, max int) []*scheduledOp {
+	for len(batch) < max {
+		var best *scheduledOp
+		now := time.Now()
+		for _, queue := range s.pending {
+			if head := queue[0]; head.Type == opType && !now.Before(head.notBefore) && (best == nil || head.seq < best.seq) {
+				best = head
+			}
+		}
+		if best == nil {
+			break
+		}
+		s.remove(best)
+		batch = append(batch, best)
+	}
+	return batch
+}
+
+// takeNext removes and returns the best runnable operation; caller holds mu
+// Only the head of each app's queue is runnable, so per-app order is kept.
+// Without a runnable operation, held reports when the next held one is due
+// (0 = none held).
+func (s *opScheduler) takeNext(now time.Time) (best *scheduledOp, held time.Duration) {
+	for _, queue := range s.pending {
+		head := queue[0]
+		if wait := head.notBefore.Sub(now); wait > 0 {
+			if held == 0 || wait < held {
+				held = wait
+			}
+			continue
+		}
+		if best == nil {
+			best = head
+			continue
+		}
+		if s.before(head, best, now) {
+			best = head
+		}
+	}
+	if best != nil {
+		s.remove(best)
+	}
+	return best, held
+}
+
+// before reports whether runnable op a should run before b: starved
+// operations first, then by priority, FIFO within each
+func (s *opScheduler) before(a, b *scheduledOp, now time.Time) bool {
+	as, bs := now.Sub(a.runnableSince()) >= starvationAge, now.Sub(b.runnableSince()) >= starvationAge
+	if as != bs {
+		return as
+	}
+	if !as {
+		if ap, bp := priorityFor(a.Type), priorityFor(b.Type); ap != bp {
+			return ap > bp
+		}
+	}
+	return a.seq < b.seq
+}
+
+// close completes every queued operation with err and makes later pushes
+// fail with it, so nobody waits on a worker that has stopped
+func (s *opScheduler) close(err error) {
+	s.mu.Lock()
+	s.closed = err
+	var ops []*scheduledOp
+	for _, queue := range s.pending {
+		ops = append(ops, queue...)
+	}
+	s.pending = make(map[string][]*scheduledOp)
+	s.size = 0
+	queueDepth.Set(0)
+	s.invalidate()
+	s.mu.Unlock()
+
+	for _, op := range ops {
+		if op.AppDir != "" {
+			os.RemoveAll(op.AppDir)
+		}
+		op.complete(err)
+	}
+	if len(ops) > 0 {
+		slog.Info("Cancelled queued operations", "count", len(ops))
+	}
+}
+
+// remove takes the head op off its app's queue; caller holds mu
+func (s *opScheduler) remove(op *scheduledOp) {
+	queue := s.pending[op.AppName][1:]
+	if len(queue) == 0 {
+		delete(s.pending, op.AppName)
+	} else {
+		s.pending[op.AppName] = queue
+	}
+	s.size--
+	queueDepth.Set(float64(s.size))
+	queueWait.Since(op.Type, op.queuedAt)
+	s.invalidate()
+}
+
+// invalidate drops the cached Snapshot view; caller holds mu. The view is
+// rebuilt on the next read, so push and remove stay O(1) however long the
+// queue is.
+func (s *opScheduler) invalidate() {
+	s.view.Store(nil)
+}
+
+// Snapshot returns the queued operations in submission order. Reads between
+// changes share one view without locking.
+func (s *opScheduler) Snapshot() []QueuedOperation {
+	if view := s.view.Load(); view != nil {
+		return *view
+	}
+
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if view := s.view.Load(); view != nil {
+		return *view
+	}
+	ops := make([]*scheduledOp, 0, s.size)
+	for _, queue := range s.pending {
+		ops = append(ops, queue...)
+	}
+	sort.Slice(ops, func(a, b int) bool { return ops[a].seq < ops[b].seq })
+
+	view := make([]QueuedOperation, len(ops))
+	for n, op := range ops {
+		view[n] = op.describe()
+	}
+	s.view.Store(&view)
+	return view
+}
+
+// Len returns the number of queued (not yet running) operations
+func (s *opScheduler) Len() int {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	return s.size
+}
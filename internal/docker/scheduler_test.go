@@ -0,0 +1,237 @@
+package docker
+
+import (
+	"context"
+	"errors"
+	"os"
+	"testing"
+	"time"
+)
+
+// pushOp queues an operation and returns its result channel
+func pushOp(s *opScheduler, opType, appName, appDir string) chan error {
+	ch := make(chan error, 1)
+	s.push(&AppOperation{Type: opType, AppName: appName, AppDir: appDir, ResultCh: ch})
+	return ch
+}
+
+// popAll drains the scheduler and returns "type:app" in execution order
+func popAll(t *testing.T, s *opScheduler) []string {
+	t.Helper()
+	var order []string
+	for s.Len() > 0 {
+		op, ok := s.pop(context.Background(), nil)
+		if !ok {
+			t.Fatal("pop returned no operation")
+		}
+		order = append(order, op.Type+":"+op.AppName)
+		op.complete(nil)
+	}
+	return order
+}
+
+// TestOpScheduler_InstallThenUninstallCancels tests that install followed by uninstall runs nothing
+func TestOpScheduler_InstallThenUninstallCancels(t *testing.T) {
+	s := newOpScheduler()
+	appDir := t.TempDir()
+
+	install := pushOp(s, "install", "watchcow.a", appDir)
+	uninstall := pushOp(s, "uninstall", "watchcow.a", "")
+
+	if err := <-install; !errors.Is(err, ErrOperationSuperseded) {
+		t.Errorf("expected install to be superseded, got %v", err)
+	}
+	if err := <-uninstall; err != nil {
+		t.Errorf("expected uninstall to complete without running, got %v", err)
+	}
+	if s.Len() != 0 {
+		t.Errorf("expected empty queue, got %d", s.Len())
+	}
+	if _, err := os.Stat(appDir); !os.IsNotExist(err) {
+		t.Error("expected superseded install directory to be removed")
+	}
+}
+
+// TestOpScheduler_RunOpsCollapse tests that only the latest start/stop per app survives
+func TestOpScheduler_RunOpsCollapse(t *testing.T) {
+	s := newOpScheduler()
+
+	start1 := pushOp(s, "start", "watchcow.a", "")
+	stop := pushOp(s, "stop", "watchcow.a", "")
+	start2 := pushOp(s, "start", "watchcow.a", "")
+	start3 := pushOp(s, "start", "watchcow.a", "")
+
+	if err := <-start1; !errors.Is(err, ErrOperationSuperseded) {
+		t.Errorf("expected first start to be superseded, got %v", err)
+	}
+	if err := <-stop; !errors.Is(err, ErrOperationSuperseded) {
+		t.Errorf("expected stop to be superseded, got %v", err)
+	}
+
+	if got := popAll(t, s); len(got) != 1 || got[0] != "start:watchcow.a" {
+		t.Fatalf("expected a single start, got %v", got)
+	}
+	// Merged duplicates share the result of the operation that ran
+	if err := <-start2; err != nil {
+		t.Errorf("start2: unexpected error %v", err)
+	}
+	if err := <-start3; err != nil {
+		t.Errorf("start3: unexpected error %v", err)
+	}
+}
+
+// TestOpScheduler_PriorityAndPerAppOrder tests that start/stop jump ahead of installs for other apps
+// while operations for a single app keep their submission order
+func TestOpScheduler_PriorityAndPerAppOrder(t *testing.T) {
+	s := newOpScheduler()
+
+	pushOp(s, "install", "watchcow.a", "")
+	pushOp(s, "install", "watchcow.b", "")
+	pushOp(s, "start", "watchcow.b", "")
+	pushOp(s, "uninstall", "watchcow.c", "")
+	pushOp(s, "stop", "watchcow.d", "")
+
+	want := []string{
+		"stop:watchcow.d",
+		"uninstall:watchcow.c",
+		"install:watchcow.a",
+		"install:watchcow.b",
+		"start:watchcow.b",
+	}
+	got := popAll(t, s)
+	if len(got) != len(want) {
+		t.Fatalf("expected %v, got %v", want, got)
+	}
+	for i := range want {
+		if got[i] != want[i] {
+			t.Fatalf("expected %v, got %v", want, got)
+		}
+	}
+}
+
+// TestOpScheduler_PopBatch tests that same-type heads of other apps join a batch
+func TestOpScheduler_PopBatch(t *testing.T) {
+	s := newOpScheduler()
+	pushOp(s, "start", "watchcow.a", "")
+	pushOp(s, "install", "watchcow.b", t.TempDir())
+	pushOp(s, "start", "watchcow.c", "")
+	pushOp(s, "stop", "watchcow.d", "")
+
+	batchable := func(opType string) bool { return isRunOp(opType) }
+	batch, ok := s.popBatch(context.Background(), nil, batchable, -1, 8)
+	if !ok {
+		t.Fatal("popBatch returned no operation")
+	}
+	var got []string
+	for _, op := range batch {
+		got = append(got, op.Type+":"+op.AppName)
+		op.complete(nil)
+	}
+	if len(got) != 2 || got[0] != "start:watchcow.a" || got[1] != "start:watchcow.c" {
+		t.Errorf("batch = %v, want [start:watchcow.a start:watchcow.c]", got)
+	}
+
+	// While a burst is being batched, a late arrival within the window
+	// joins; max caps the batch
+	pushOp(s, "stop", "watchcow.e", "")
+	pushOp(s, "stop", "watchcow.f", "")
+	go func() {
+		time.Sleep(20 * time.Millisecond)
+		pushOp(s, "stop", "watchcow.g", "")
+	}()
+	batch, _ = s.popBatch(context.Background(), nil, batchable, 5*time.Second, 4)
+	if len(batch) != 4 {
+		t.Fatalf("batch size = %d, want 4", len(batch))
+	}
+	for _, op := range batch {
+		op.complete(nil)
+	}
+
+	// A lone operation does not wait out the window
+	pushOp(s, "stop", "watchcow.h", "")
+	start := time.Now()
+	batch, _ = s.popBatch(context.Background(), nil, batchable, 5*time.Second, 8)
+	if len(batch) != 1 || time.Since(start) > time.Second {
+		t.Fatalf("lone stop: batch size = %d after %v", len(batch), time.Since(start))
+	}
+	batch[0].complete(nil)
+
+	// Non-batchable types run alone
+	batch, _ = s.popBatch(context.Background(), nil, batchable, 5*time.Second, 8)
+	if len(batch) != 1 || batch[0].Type != "install" {
+		t.Errorf("expected install to run alone, got %d ops", len(batch))
+	}
+}
+
+// TestOpScheduler_HeldUninstallSuperseded tests that an uninstall waits for
+// uninstallDelay and that a start or install arriving meanwhile replaces it
+func TestOpScheduler_HeldUninstallSuperseded(t *testing.T) {
+	s := newOpScheduler()
+	s.uninstallDelay = time.Hour
+
+	uninstall := pushOp(s, "uninstall", "watchcow.a", "")
+	if op, held := s.takeNext(time.Now()); op != nil || held <= 0 {
+		t.Fatalf("takeNext = %v, %v; want the uninstall held", op, held)
+	}
+	pushOp(s, "start", "watchcow.a", "")
+	if err := <-uninstall; !errors.Is(err, ErrOperationSuperseded) {
+		t.Errorf("expected the uninstall to be superseded by the start, got %v", err)
+	}
+	if got := popAll(t, s); len(got) != 1 || got[0] != "start:watchcow.a" {
+		t.Errorf("expected only the start, got %v", got)
+	}
+
+	// An install while the app is still installed becomes an upgrade
+	pushOp(s, "uninstall", "watchcow.a", "")
+	pushOp(s, "install", "watchcow.a", t.TempDir())
+	if got := popAll(t, s); len(got) != 1 || got[0] != "upgrade:watchcow.a" {
+		t.Errorf("expected a single upgrade, got %v", got)
+	}
+
+	// Without anything taking the app over, the uninstall runs once due
+	s.uninstallDelay = 20 * time.Millisecond
+	pushOp(s, "uninstall", "watchcow.a", "")
+	start := time.Now()
+	if got := popAll(t, s); len(got) != 1 || got[0] != "uninstall:watchcow.a" {
+		t.Errorf("expected the uninstall, got %v", got)
+	}
+	if waited := time.Since(start); waited < 20*time.Millisecond {
+		t.Errorf("uninstall ran after %v, before its delay", waited)
+	}
+}
+
+// TestOpScheduler_StarvedInstallRunsFirst tests that an install waiting past
+// starvationAge goes ahead of newer start/stop ops
+func TestOpScheduler_StarvedInstallRunsFirst(t *testing.T) {
+	s := newOpScheduler()
+	pushOp(s, "install", "watchcow.a", "")
+	s.pending["watchcow.a"][0].queuedAt = time.Now().Add(-2 * starvationAge)
+	pushOp(s, "start", "watchcow.b", "")
+	pushOp(s, "stop", "watchcow.c", "")
+
+	if got := popAll(t, s); len(got) != 3 || got[0] != "install:watchcow.a" {
+		t.Errorf("expected the starved install first, got %v", got)
+	}
+}
+
+// TestOpScheduler_CloseCompletesPending tests that close fails queued
+// operations and later pushes instead of leaving callers waiting
+func TestOpScheduler_CloseCompletesPending(t *testing.T) {
+	s := newOpScheduler()
+	appDir := t.TempDir()
+	queued := pushOp(s, "install", "watchcow.a", appDir)
+
+	s.close(ErrMonitorStopped)
+	if err := <-queued; !errors.Is(err, ErrMonitorStopped) {
+		t.Errorf("queued op: expected ErrMonitorStopped, got %v", err)
+	}
+	if _, err := os.Stat(appDir); !os.IsNotExist(err) {
+		t.Error("expected the queued package directory to be removed")
+	}
+	if err := <-pushOp(s, "start", "watchcow.b", ""); !errors.Is(err, ErrMonitorStopped) {
+		t.Errorf("push after close: expected ErrMonitorStopped, got %v", err)
+	}
+	if s.Len() != 0 {
+		t.Errorf("Len = %d after close, want 0", s.Len())
+	}
+}
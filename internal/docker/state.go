@@ -0,0 +1,177 @@
+package docker
+
+import (
+	"hash/fnv"
+	"sync"
+)
+
+// stateShards is the number of independently locked parts of containerTable
+const stateShards = 16
+
+// containerTable holds the tracked containers, sharded by container ID so
+// handlers for different containers do not contend on one lock. Writes for a
+// single container are ordered by its actor (see actors), so the shard locks
+// only guard the maps themselves. Every write calls onChange, so readers of
+// published snapshots see it without polling.
+type containerTable struct {
+	shards   [stateShards]stateShard
+	onChange func() // Called after each change, outside the shard locks (nil = none)
+}
+
+type stateShard struct {
+	mu         sync.RWMutex
+	containers map[string]*ContainerState // map[containerID]state
+}
+
+// newContainerTable creates an empty table that calls onChange after writes
+func newContainerTable(onChange func()) *containerTable {
+	t := &containerTable{onChange: onChange}
+	for i := range t.shards {
+		t.shards[i].containers = make(map[string]*ContainerState)
+	}
+	return t
+}
+
+func (t *containerTable) shard(containerID string) *stateShard {
+	return &t.shards[t.indexOf(containerID)]
+}
+
+func (t *containerTable) indexOf(containerID string) uint32 {
+	h := fnv.New32a()
+	h.Write([]byte(containerID))
+	return h.Sum32() % stateShards
+}
+
+// get returns a copy of a container's state
+func (t *containerTable) get(containerID string) (ContainerState, bool) {
+	s := t.shard(containerID)
+	s.mu.RLock()
+	defer s.mu.RUnlock()
+	if state, ok := s.containers[containerID]; ok {
+		return *state, true
+	}
+	return ContainerState{}, false
+}
+
+// put stores a container's state, replacing any previous one
+func (t *containerTable) put(state ContainerState) {
+	s := t.shard(state.ContainerID)
+	s.mu.Lock()
+	s.containers[state.ContainerID] = &state
+	s.mu.Unlock()
+	t.changed()
+}
+
+// update applies fn to a tracked container; it reports whether fn changed it
+func (t *containerTable) update(containerID string, fn func(*ContainerState) bool) bool {
+	s := t.shard(containerID)
+	s.mu.Lock()
+	changed := false
+	if state, ok := s.containers[containerID]; ok {
+		changed = fn(state)
+	}
+	s.mu.Unlock()
+	if changed {
+		t.changed()
+	}
+	return changed
+}
+
+// remove forgets a container
+func (t *containerTable) remove(containerID string) {
+	s := t.shard(containerID)
+	s.mu.Lock()
+	delete(s.containers, containerID)
+	s.mu.Unlock()
+	t.changed()
+}
+
+// all returns copies of every tracked container
+func (t *containerTable) all() map[string]*ContainerState {
+	result := make(map[string]*ContainerState)
+	for i := range t.shards {
+		s := &t.shards[i]
+		s.mu.RLock()
+		for id, state := range s.containers {
+			copied := *state
+			result[id] = &copied
+		}
+		s.mu.RUnlock()
+	}
+	return result
+}
+
+// replace swaps in a restored set of containers
+func (t *containerTable) replace(containers map[string]*ContainerState) {
+	fresh := make([]map[string]*ContainerState, stateShards)
+	for i := range fresh {
+		fresh[i] = make(map[string]*ContainerState)
+	}
+	for id, state := range containers {
+		copied := *state
+		fresh[t.indexOf(id)][id] = &copied
+	}
+	for i := range t.shards {
+		s := &t.shards[i]
+		s.mu.Lock()
+		s.containers = fresh[i]
+		s.mu.Unlock()
+	}
+	t.changed()
+}
+
+func (t *containerTable) changed() {
+	if t.onChange != nil {
+		t.onChange()
+	}
+}
+
+// actors runs work for each container in submission order, one goroutine
+// per container with pending work, so a destroy never overtakes the start
+// handler of the same container while different containers run in parallel
+type actors struct {
+	mu     sync.Mutex
+	queues map[string][]func() // map[containerID]pending work; present while a goroutine runs
+}
+
+// newActors creates an idle executor
+func newActors() *actors {
+	return &actors{queues: make(map[string][]func())}
+}
+
+// submit queues fn for containerID and returns a channel closed after fn has run
+func (a *actors) submit(containerID string, fn func()) <-chan struct{} {
+	done := make(chan struct{})
+	job := func() {
+		defer close(done)
+		fn()
+	}
+
+	a.mu.Lock()
+	queue, running := a.queues[containerID]
+	a.queues[containerID] = append(queue, job)
+	a.mu.Unlock()
+
+	if !running {
+		go a.run(containerID)
+	}
+	return done
+}
+
+// run drains one container's queue and exits when it is empty
+func (a *actors) run(containerID string) {
+	for {
+		a.mu.Lock()
+		queue := a.queues[containerID]
+		if len(queue) == 0 {
+			delete(a.queues, containerID)
+			a.mu.Unlock()
+			return
+		}
+		job := queue[0]
+		a.queues[containerID] = queue[1:]
+		a.mu.Unlock()
+
+		job()
+	}
+}
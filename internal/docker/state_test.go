@@ -0,0 +1,103 @@
+package docker
+
+import (
+	"sync"
+	"testing"
+	"time"
+)
+
+// TestContainerTable tests copies, updates and restore across shards
+func TestContainerTable(t *testing.T) {
+	table := newContainerTable(nil)
+	table.put(ContainerState{ContainerID: "aaaaaaaaaaaa", AppName: "watchcow.a"})
+	table.put(ContainerState{ContainerID: "bbbbbbbbbbbb", AppName: "watchcow.b"})
+
+	state, ok := table.get("aaaaaaaaaaaa")
+	if !ok || state.AppName != "watchcow.a" {
+		t.Fatalf("get() = %+v, %v", state, ok)
+	}
+	state.AppName = "changed"
+	if state, _ := table.get("aaaaaaaaaaaa"); state.AppName != "watchcow.a" {
+		t.Error("get() result aliases the table")
+	}
+
+	if table.update("missing", func(*ContainerState) bool { return true }) {
+		t.Error("update() of an untracked container reported a change")
+	}
+	table.update("bbbbbbbbbbbb", func(s *ContainerState) bool {
+		s.Installed = true
+		return true
+	})
+	if state, _ := table.get("bbbbbbbbbbbb"); !state.Installed {
+		t.Error("update() was not applied")
+	}
+
+	table.remove("aaaaaaaaaaaa")
+	if all := table.all(); len(all) != 1 || all["bbbbbbbbbbbb"] == nil {
+		t.Errorf("all() = %v", all)
+	}
+
+	table.replace(map[string]*ContainerState{"cccccccccccc": {ContainerID: "cccccccccccc"}})
+	if all := table.all(); len(all) != 1 || all["cccccccccccc"] == nil {
+		t.Errorf("all() after replace = %v", all)
+	}
+}
+
+// TestActors_OrderPerContainer tests that one container's work runs in
+// submission order while other containers are not held up
+func TestActors_OrderPerContainer(t *testing.T) {
+	a := newActors()
+	var mu sync.Mutex
+	var order []string
+	record := func(s string) {
+		mu.Lock()
+		order = append(order, s)
+		mu.Unlock()
+	}
+
+	release := make(chan struct{})
+	a.submit("web", func() {
+		<-release // A slow start handler
+		record("web:start")
+	})
+	destroyed := a.submit("web", func() { record("web:destroy") })
+
+	select {
+	case <-a.submit("db", func() { record("db:start") }):
+	case <-time.After(5 * time.Second):
+		t.Fatal("db was blocked behind web")
+	}
+
+	select {
+	case <-destroyed:
+		t.Fatal("destroy overtook the running start")
+	case <-time.After(20 * time.Millisecond):
+	}
+	close(release)
+	<-destroyed
+
+	mu.Lock()
+	want := []string{"db:start", "web:start", "web:destroy"}
+	for n := range want {
+		if n >= len(order) || order[n] != want[n] {
+			t.Errorf("order = %v, want %v", order, want)
+			break
+		}
+	}
+	mu.Unlock()
+
+	// The goroutine exits just after its last job
+	deadline := time.Now().Add(time.Second)
+	for {
+		a.mu.Lock()
+		idle := len(a.queues) == 0
+		a.mu.Unlock()
+		if idle {
+			break
+		}
+		if time.Now().After(deadline) {
+			t.Fatal("idle actors left behind")
+		}
+		time.Sleep(time.Millisecond)
+	}
+}
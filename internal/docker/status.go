@@ -0,0 +1,74 @@
+package docker
+
+import (
+	"log/slog"
+	"strings"
+	"time"
+
+	"github.com/docker/docker/api/types/container"
+	"github.com/docker/docker/api/types/events"
+)
+
+// publishStatus updates the status file of a managed container as soon as
+// its event arrives, ahead of debouncing, so cmd/main status checks see it
+func (m *Monitor) publishStatus(event events.Message) {
+	if m.status == nil || !shouldInstall(event.Actor.Attributes) {
+		return
+	}
+	name := event.Actor.Attributes["name"]
+
+	m.statusMu.Lock()
+	defer m.statusMu.Unlock()
+	if m.statusAt == nil {
+		m.statusAt = make(map[string]time.Time)
+	}
+	m.statusAt[name] = time.Now()
+
+	var err error
+	switch event.Action {
+	case "start":
+		err = m.status.Set(name, true)
+	case "stop", "die":
+		err = m.status.Set(name, false)
+	case "destroy":
+		err = m.status.Remove(name)
+	}
+	if err != nil {
+		slog.Warn("Failed to update status file", "container", name, "error", err)
+	}
+}
+
+// syncStatus rewrites all status files from a full container list taken at
+// listedAt, covering containers that changed while no events were received.
+// Files an event wrote after listedAt are newer than the list and kept.
+func (m *Monitor) syncStatus(list []container.Summary, listedAt time.Time) {
+	if m.status == nil {
+		return
+	}
+	m.statusMu.Lock()
+	defer m.statusMu.Unlock()
+	for name, at := range m.statusAt {
+		if at.Before(listedAt) {
+			delete(m.statusAt, name) // The list is newer
+		}
+	}
+	newer := func(name string) bool {
+		_, ok := m.statusAt[name]
+		return ok
+	}
+	if err := m.status.Sync(containerStatuses(list), newer); err != nil {
+		slog.Warn("Failed to sync status files", "error", err)
+	}
+}
+
+// containerStatuses maps managed container names to whether they are running
+func containerStatuses(list []container.Summary) map[string]bool {
+	states := make(map[string]bool)
+	for _, ctr := range list {
+		if len(ctr.Names) == 0 || !shouldInstall(ctr.Labels) {
+			continue
+		}
+		states[strings.TrimPrefix(ctr.Names[0], "/")] = ctr.State == "running"
+	}
+	return states
+}
@@ -0,0 +1,120 @@
+package docker
+
+import (
+	"encoding/json"
+	"net/http"
+	"sort"
+	"strings"
+	"time"
+)
+
+// DefaultStatusSocket is where watchcow serves StatusHandler
+const DefaultStatusSocket = "/run/watchcow/status.sock"
+
+// StatusSnapshot is an immutable view of the tracked containers. A new one
+// is published after every write to the container table, so readers load a
+// pointer instead of locking the container table. Labels are left out: the
+// status socket is readable by every local user and labels may hold secrets.
+type StatusSnapshot struct {
+	Containers []ContainerState `json:"containers"` // Sorted by container name
+	UpdatedAt  time.Time        `json:"updated_at"`
+}
+
+// QueuedOperation describes one pending or running appcenter operation
+type QueuedOperation struct {
+	Type     string    `json:"type"`
+	AppName  string    `json:"app_name"`
+	QueuedAt time.Time `json:"queued_at"`
+}
+
+// Status is the body of GET /v1/status
+type Status struct {
+	*StatusSnapshot
+	Running []QueuedOperation `json:"running"`
+	Queue   []QueuedOperation `json:"queue"`
+}
+
+// publishSnapshot copies the tracked containers into a new StatusSnapshot;
+// the container table calls it after every write. Publishers are serialized
+// so a slower one cannot replace a newer snapshot with an older one.
+func (m *Monitor) publishSnapshot() {
+	m.snapshotMu.Lock()
+	defer m.snapshotMu.Unlock()
+	tracked := m.containers.all()
+	containers := make([]ContainerState, 0, len(tracked))
+	for _, state := range tracked {
+		state.Labels = nil // all() returned copies
+		containers = append(containers, *state)
+	}
+
+	sort.Slice(containers, func(a, b int) bool {
+		return containers[a].ContainerName < containers[b].ContainerName
+	})
+	m.snapshot.Store(&StatusSnapshot{Containers: containers, UpdatedAt: time.Now()})
+}
+
+// Snapshot returns the latest container state snapshot; it never blocks
+func (m *Monitor) Snapshot() *StatusSnapshot {
+	if s := m.snapshot.Load(); s != nil {
+		return s
+	}
+	return &StatusSnapshot{}
+}
+
+// Status returns the container snapshot plus the operation queue
+func (m *Monitor) Status() Status {
+	running := m.running.Load()
+	status := Status{StatusSnapshot: m.Snapshot(), Queue: m.ops.Snapshot()}
+	if running != nil {
+		status.Running = *running
+	}
+	return status
+}
+
+// setRunning publishes the operations the worker is executing (nil = idle)
+func (m *Monitor) setRunning(batch []*scheduledOp) {
+	if batch == nil {
+		m.running.Store(nil)
+		return
+	}
+	running := make([]QueuedOperation, len(batch))
+	for n, op := range batch {
+		running[n] = op.describe()
+	}
+	m.running.Store(&running)
+}
+
+// StatusHandler serves read-only status, all from snapshots:
+//
+//	GET /v1/status            containers, running and queued operations
+//	GET /v1/containers/<name> one container, by container or app name
+func (m *Monitor) StatusHandler() http.Handler {
+	mux := http.NewServeMux()
+	mux.HandleFunc("/v1/status", func(w http.ResponseWriter, r *http.Request) {
+		if r.Method != http.MethodGet {
+			http.Error(w, "method not allowed", http.StatusMethodNotAllowed)
+			return
+		}
+		writeJSON(w, m.Status())
+	})
+	mux.HandleFunc("/v1/containers/", func(w http.ResponseWriter, r *http.Request) {
+		if r.Method != http.MethodGet {
+			http.Error(w, "method not allowed", http.StatusMethodNotAllowed)
+			return
+		}
+		name := strings.TrimPrefix(r.URL.Path, "/v1/containers/")
+		for _, state := range m.Snapshot().Containers {
+			if state.ContainerName == name || state.AppName == name {
+				writeJSON(w, state)
+				return
+			}
+		}
+		http.Error(w, "container not tracked", http.StatusNotFound)
+	})
+	return mux
+}
+
+func writeJSON(w http.ResponseWriter, v any) {
+	w.Header().Set("Content-Type", "application/json")
+	json.NewEncoder(w).Encode(v)
+}
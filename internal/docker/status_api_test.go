@@ -0,0 +1,122 @@
+package docker
+
+import (
+	"encoding/json"
+	"net/http"
+	"net/http/httptest"
+	"testing"
+	"time"
+)
+
+// newTestMonitor returns a Monitor with just the state needed for status reads
+func newTestMonitor() *Monitor {
+	m := &Monitor{ops: newOpScheduler()}
+	m.containers = newContainerTable(m.publishSnapshot)
+	return m
+}
+
+// TestStatus_PendingInstallVisible tests that a container recorded by
+// handleContainerStart is visible before its install completes
+func TestStatus_PendingInstallVisible(t *testing.T) {
+	m := newTestMonitor()
+
+	// What handleContainerStart does before queueing the install
+	m.containers.put(ContainerState{ContainerID: "aaaaaaaaaaaa", ContainerName: "web", AppName: "watchcow.web"})
+	pushOp(m.ops, "install", "watchcow.web", t.TempDir())
+
+	status := m.Status()
+	if len(status.Containers) != 1 || status.Containers[0].Installed {
+		t.Fatalf("containers = %+v, want the uninstalled web container", status.Containers)
+	}
+	if len(status.Queue) != 1 || status.Queue[0].Type != "install" {
+		t.Errorf("queue = %+v", status.Queue)
+	}
+
+	// The queue view is rebuilt after every push and pop
+	pushOp(m.ops, "start", "watchcow.db", "")
+	if queue := m.Status().Queue; len(queue) != 2 || queue[1].AppName != "watchcow.db" {
+		t.Errorf("queue after push = %+v", queue)
+	}
+	m.ops.mu.Lock()
+	m.ops.takeNext(time.Now())
+	m.ops.mu.Unlock()
+	if queue := m.Status().Queue; len(queue) != 1 || queue[0].Type != "install" {
+		t.Errorf("queue after pop = %+v", queue)
+	}
+	if states := m.GetContainerStates(); states["aaaaaaaaaaaa"] == nil {
+		t.Error("GetContainerStates misses the pending container")
+	}
+
+	m.containers.update("aaaaaaaaaaaa", func(s *ContainerState) bool {
+		s.Installed = true
+		return true
+	})
+	if !m.Snapshot().Containers[0].Installed {
+		t.Error("update was not published")
+	}
+	m.containers.remove("aaaaaaaaaaaa")
+	if len(m.Snapshot().Containers) != 0 {
+		t.Error("remove was not published")
+	}
+}
+
+// TestStatusHandler tests the status API against published snapshots
+func TestStatusHandler(t *testing.T) {
+	m := newTestMonitor()
+	m.containers.put(ContainerState{ContainerID: "bbbbbbbbbbbb", ContainerName: "web", AppName: "watchcow.web", Installed: true,
+		Labels: map[string]string{"watchcow.enable": "true", "watchcow.env.TOKEN": "secret"}})
+	m.containers.put(ContainerState{ContainerID: "aaaaaaaaaaaa", ContainerName: "db", AppName: "watchcow.db", Stopped: true})
+	pushOp(m.ops, "install", "watchcow.web", t.TempDir())
+
+	srv := httptest.NewServer(m.StatusHandler())
+	defer srv.Close()
+
+	resp, err := http.Get(srv.URL + "/v1/status")
+	if err != nil {
+		t.Fatal(err)
+	}
+	var status struct {
+		Containers []ContainerState  `json:"containers"`
+		Queue      []QueuedOperation `json:"queue"`
+	}
+	json.NewDecoder(resp.Body).Decode(&status)
+	resp.Body.Close()
+
+	if len(status.Containers) != 2 || status.Containers[0].ContainerName != "db" || !status.Containers[0].Stopped {
+		t.Errorf("containers = %+v", status.Containers)
+	}
+	if len(status.Queue) != 1 || status.Queue[0].Type != "install" || status.Queue[0].AppName != "watchcow.web" {
+		t.Errorf("queue = %+v", status.Queue)
+	}
+
+	resp, err = http.Get(srv.URL + "/v1/containers/watchcow.web")
+	if err != nil {
+		t.Fatal(err)
+	}
+	var state ContainerState
+	json.NewDecoder(resp.Body).Decode(&state)
+	resp.Body.Close()
+	if resp.StatusCode != http.StatusOK || state.ContainerID != "bbbbbbbbbbbb" {
+		t.Errorf("container lookup = %d %+v", resp.StatusCode, state)
+	}
+	if state.Labels != nil {
+		t.Errorf("labels served over the status socket: %v", state.Labels)
+	}
+	if m.GetContainerStates()["bbbbbbbbbbbb"].Labels == nil {
+		t.Error("dropping labels from the snapshot changed the tracked state")
+	}
+
+	resp, _ = http.Get(srv.URL + "/v1/containers/missing")
+	resp.Body.Close()
+	if resp.StatusCode != http.StatusNotFound {
+		t.Errorf("missing container status = %d, want 404", resp.StatusCode)
+	}
+
+	// Copies handed out do not alias the snapshot
+	for _, s := range m.GetContainerStates() {
+		s.AppName = "changed"
+	}
+	if m.Snapshot().Containers[1].AppName != "watchcow.web" {
+		t.Error("GetContainerStates result aliases the snapshot")
+	}
+}
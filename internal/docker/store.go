@@ -0,0 +1,69 @@
+package docker
+
+import (
+	"encoding/json"
+	"fmt"
+	"os"
+	"sync"
+
+	"watchcow/internal/fpkgen"
+)
+
+// stateFileVersion is bumped when the on-disk layout changes incompatibly
+const stateFileVersion = 1
+
+// stateFile is the on-disk snapshot of tracked containers
+type stateFile struct {
+	Version    int                        `json:"version"`
+	Containers map[string]*ContainerState `json:"containers"` // map[containerID]state
+}
+
+// stateStore persists container states as a JSON snapshot, replaced atomically on save
+type stateStore struct {
+	path string
+	mu   sync.Mutex // Serializes snapshot+write so saves land in order
+}
+
+// newStateStore creates a store backed by path
+func newStateStore(path string) *stateStore {
+	return &stateStore{path: path}
+}
+
+// load reads the snapshot; a missing file yields an empty state
+func (s *stateStore) load() (map[string]*ContainerState, error) {
+	data, err := os.ReadFile(s.path)
+	if os.IsNotExist(err) {
+		return map[string]*ContainerState{}, nil
+	}
+	if err != nil {
+		return nil, fmt.Errorf("failed to read state: %w", err)
+	}
+
+	var f stateFile
+	if err := json.Unmarshal(data, &f); err != nil {
+		return nil, fmt.Errorf("failed to parse state: %w", err)
+	}
+	if f.Version != stateFileVersion {
+		return nil, fmt.Errorf("unsupported state version %d", f.Version)
+	}
+	if f.Containers == nil {
+		f.Containers = map[string]*ContainerState{}
+	}
+	return f.Containers, nil
+}
+
+// save writes the snapshot returned by snapshot, which runs under the store lock
+// so that concurrent saves cannot overwrite a newer snapshot with an older one
+func (s *stateStore) save(snapshot func() map[string]*ContainerState) error {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	data, err := json.MarshalIndent(stateFile{Version: stateFileVersion, Containers: snapshot()}, "", "  ")
+	if err != nil {
+		return fmt.Errorf("failed to encode state: %w", err)
+	}
+	if err := fpkgen.WriteFileAtomic(s.path, data, 0644); err != nil {
+		return fmt.Errorf("failed to write state: %w", err)
+	}
+	return nil
+}
@@ -0,0 +1,52 @@
+package docker
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+)
+
+// TestStateStore_RoundTrip tests that saved container states load back unchanged
+func TestStateStore_RoundTrip(t *testing.T) {
+	store := newStateStore(filepath.Join(t.TempDir(), "state.json"))
+
+	containers, err := store.load()
+	if err != nil || len(containers) != 0 {
+		t.Fatalf("expected empty state for missing file, got %v, %v", containers, err)
+	}
+
+	want := map[string]*ContainerState{
+		"abcdef123456": {
+			ContainerID:   "abcdef123456",
+			ContainerName: "nginx",
+			AppName:       "watchcow.nginx",
+			Installed:     true,
+			Labels:        map[string]string{"watchcow.enable": "true"},
+			PackageHash:   "0123abcd",
+		},
+	}
+	if err := store.save(func() map[string]*ContainerState { return want }); err != nil {
+		t.Fatalf("save failed: %v", err)
+	}
+
+	got, err := store.load()
+	if err != nil {
+		t.Fatalf("load failed: %v", err)
+	}
+	state := got["abcdef123456"]
+	if state == nil || state.AppName != "watchcow.nginx" || !state.Installed ||
+		state.PackageHash != "0123abcd" || state.Labels["watchcow.enable"] != "true" {
+		t.Errorf("unexpected restored state: %+v", state)
+	}
+}
+
+// TestStateStore_RejectsUnknownVersion tests that a snapshot from an incompatible layout is not used
+func TestStateStore_RejectsUnknownVersion(t *testing.T) {
+	path := filepath.Join(t.TempDir(), "state.json")
+	if err := os.WriteFile(path, []byte(`{"version": 99, "containers": {}}`), 0644); err != nil {
+		t.Fatalf("Failed to write state: %v", err)
+	}
+	if _, err := newStateStore(path).load(); err == nil {
+		t.Error("expected error for unknown state version")
+	}
+}
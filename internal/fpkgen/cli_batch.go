@@ -0,0 +1,108 @@
+package fpkgen
+
+import (
+	"context"
+	"log/slog"
+	"strings"
+	"time"
+)
+
+// SupportsBatch reports whether one appcenter-cli op invocation can target
+// several apps. It reads the op's usage once (appcenter-cli op --help) and
+// caches the answer; an unreadable or single-target usage means per-app calls.
+func (i *CLIInstaller) SupportsBatch(op string) bool {
+	i.batchMu.Lock()
+	defer i.batchMu.Unlock()
+	if supported, ok := i.batchOps[op]; ok {
+		return supported
+	}
+	if i.batchOps == nil {
+		i.batchOps = make(map[string]bool)
+	}
+
+	ctx, cancel := context.WithTimeout(context.Background(), i.timeouts.forOp(op))
+	defer cancel()
+	help, _ := i.command(ctx, "", op, "--help").CombinedOutput() // Usage is often printed with a non-zero exit
+	supported := parseBatchUsage(string(help), op)
+
+	slog.Debug("Detected appcenter-cli batch support", "op", op, "supported", supported)
+	i.batchOps[op] = supported
+	return supported
+}
+
+// parseBatchUsage reports whether a usage text lets op take repeated app
+// names, e.g. "appcenter-cli start <appname>..." or "start APP [APP...]"
+func parseBatchUsage(help, op string) bool {
+	for _, line := range strings.Split(help, "\n") {
+		fields := strings.Fields(line)
+		for n, field := range fields {
+			if field != op {
+				continue
+			}
+			for _, arg := range fields[n+1:] {
+				// Only a repeated app-name placeholder counts, not e.g. [flags...]
+				lower := strings.ToLower(arg)
+				if strings.Contains(lower, "...") && (strings.Contains(lower, "app") || strings.Contains(lower, "name")) {
+					return true
+				}
+			}
+		}
+	}
+	return false
+}
+
+// StartApps starts several apps and returns one error per name. With batch
+// support this is a single appcenter-cli start; if that fails, each app is
+// retried on its own so every caller gets its own result.
+func (i *CLIInstaller) StartApps(ctx context.Context, appNames []string) []error {
+	return i.batchRun(ctx, "start", appNames, i.StartApp)
+}
+
+// StopApps stops several apps; see StartApps
+func (i *CLIInstaller) StopApps(ctx context.Context, appNames []string) []error {
+	return i.batchRun(ctx, "stop", appNames, i.StopApp)
+}
+
+// UninstallApps uninstalls several apps with one stop and one uninstall
+// invocation when supported; see StartApps
+func (i *CLIInstaller) UninstallApps(ctx context.Context, appNames []string) []error {
+	if len(appNames) < 2 || !i.SupportsBatch("uninstall") {
+		return eachApp(ctx, appNames, i.Uninstall)
+	}
+
+	defer cliDuration.Since("uninstall", time.Now())
+	slog.InfoContext(ctx, "Uninstalling fnOS apps", "apps", appNames)
+	if i.SupportsBatch("stop") {
+		i.tryCLI(ctx, "stop", appNames...) // Ignore stop errors
+	}
+	if err := i.runCLI(ctx, "", "uninstall", appNames...); err != nil {
+		slog.WarnContext(ctx, "Batched uninstall failed, uninstalling apps one by one", "error", err)
+		return eachApp(ctx, appNames, i.Uninstall)
+	}
+	return make([]error, len(appNames))
+}
+
+// batchRun runs op for all apps in one invocation if possible, else per app via single
+func (i *CLIInstaller) batchRun(ctx context.Context, op string, appNames []string, single func(context.Context, string) error) []error {
+	if len(appNames) > 1 && i.SupportsBatch(op) {
+		start := time.Now()
+		slog.InfoContext(ctx, "Running batched appcenter-cli operation", "op", op, "apps", appNames)
+		err := i.runCLI(ctx, "", op, appNames...)
+		cliDuration.Since(op, start)
+		if err == nil {
+			return make([]error, len(appNames))
+		}
+		slog.WarnContext(ctx, "Batched appcenter-cli operation failed, retrying apps one by one",
+			"op", op, "apps", len(appNames), "error", err)
+	}
+	return eachApp(ctx, appNames, single)
+}
+
+// eachApp runs fn for every app, collecting one error per name
+func eachApp(ctx context.Context, appNames []string, fn func(context.Context, string) error) []error {
+	errs := make([]error, len(appNames))
+	for n, name := range appNames {
+		errs[n] = fn(ctx, name)
+	}
+	return errs
+}
@@ -0,0 +1,85 @@
+package fpkgen
+
+import (
+	"context"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+)
+
+// TestParseBatchUsage tests detection of multi-app usage lines
+func TestParseBatchUsage(t *testing.T) {
+	tests := []struct {
+		help string
+		want bool
+	}{
+		{"Usage: appcenter-cli start <appname>...", true},
+		{"Usage:\n  appcenter-cli stop [--force] APP [APP...]", true},
+		{"Usage: appcenter-cli start <appname>", false},
+		{"Usage: appcenter-cli start [flags...] <appname>", false},
+		{"Usage: appcenter-cli stop <appname>...", false}, // Different subcommand
+		{"", false},
+	}
+	for _, tt := range tests {
+		if got := parseBatchUsage(tt.help, "start"); got != tt.want {
+			t.Errorf("parseBatchUsage(%q) = %v, want %v", tt.help, got, tt.want)
+		}
+	}
+}
+
+// TestStartApps_Batched tests that a multi-target CLI gets one invocation
+func TestStartApps_Batched(t *testing.T) {
+	calls := filepath.Join(t.TempDir(), "calls")
+	i := fakeCLI(t, `if [ "$2" = --help ]; then echo "Usage: appcenter-cli $1 <appname>..."; exit 0; fi
+echo "$@" >> `+calls)
+
+	errs := i.StartApps(context.Background(), []string{"watchcow.a", "watchcow.b"})
+	for _, err := range errs {
+		if err != nil {
+			t.Errorf("StartApps error: %v", err)
+		}
+	}
+	if data, _ := os.ReadFile(calls); string(data) != "start watchcow.a watchcow.b\n" {
+		t.Errorf("calls = %q", data)
+	}
+}
+
+// TestStartApps_Fallback tests per-app calls for a single-target CLI and
+// per-app results after a failed batch
+func TestStartApps_Fallback(t *testing.T) {
+	calls := filepath.Join(t.TempDir(), "calls")
+	i := fakeCLI(t, `echo "$@" >> `+calls+`
+if [ "$2" = --help ]; then echo "Usage: appcenter-cli $1 <appname>"; fi
+[ $# -eq 2 ] && [ "$2" != watchcow.bad ]`)
+
+	errs := i.StartApps(context.Background(), []string{"watchcow.a", "watchcow.bad"})
+	if errs[0] != nil || errs[1] == nil {
+		t.Errorf("errs = %v, want only watchcow.bad to fail", errs)
+	}
+	data, _ := os.ReadFile(calls)
+	if strings.Count(string(data), "--help") != 1 || strings.Contains(string(data), "watchcow.a watchcow.bad") {
+		t.Errorf("expected one probe and no batched call, got %q", data)
+	}
+
+	// A failed batch falls back to one call per app
+	i = fakeCLI(t, `if [ "$2" = --help ]; then echo "Usage: appcenter-cli $1 <appname>..."; exit 0; fi
+[ $# -eq 2 ] && [ "$2" != watchcow.bad ]`)
+	errs = i.StopApps(context.Background(), []string{"watchcow.a", "watchcow.bad"})
+	if errs[0] != nil || errs[1] == nil {
+		t.Errorf("errs = %v, want only watchcow.bad to fail", errs)
+	}
+}
+
+// TestUninstall_ReportsFailure tests that a failed uninstall is returned, so
+// an upgrade does not install over an app that is still installed
+func TestUninstall_ReportsFailure(t *testing.T) {
+	i := fakeCLI(t, `[ "$1" != uninstall ]`)
+	if err := i.Uninstall(context.Background(), "watchcow.a"); err == nil {
+		t.Error("Uninstall succeeded, want the CLI failure")
+	}
+	errs := i.UninstallApps(context.Background(), []string{"watchcow.a"})
+	if errs[0] == nil {
+		t.Error("UninstallApps succeeded, want the CLI failure")
+	}
+}
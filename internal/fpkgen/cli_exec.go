@@ -0,0 +1,165 @@
+package fpkgen
+
+import (
+	"context"
+	"errors"
+	"fmt"
+	"log/slog"
+	"os/exec"
+	"time"
+
+	"watchcow/internal/trace"
+)
+
+// ErrCLITimeout is wrapped by errors of appcenter-cli runs that hit their deadline
+var ErrCLITimeout = errors.New("appcenter-cli timed out")
+
+// CLITimeouts bounds each appcenter-cli run; a run past its deadline has its
+// whole process group killed
+type CLITimeouts struct {
+	Install time.Duration // install-local
+	Other   time.Duration // start, stop, uninstall, list
+}
+
+// DefaultCLITimeouts leaves install-local room for image pulls
+var DefaultCLITimeouts = CLITimeouts{Install: 10 * time.Minute, Other: 2 * time.Minute}
+
+// forOp returns the deadline for one appcenter-cli subcommand
+func (t CLITimeouts) forOp(op string) time.Duration {
+	if op == "install-local" {
+		return orDefaultDuration(t.Install, DefaultCLITimeouts.Install)
+	}
+	return orDefaultDuration(t.Other, DefaultCLITimeouts.Other)
+}
+
+func orDefaultDuration(d, fallback time.Duration) time.Duration {
+	if d > 0 {
+		return d
+	}
+	return fallback
+}
+
+const (
+	// cliMaxAttempts is how often idempotent subcommands are tried
+	cliMaxAttempts = 3
+
+	// defaultCLIRetryDelay is the delay before the first retry; it doubles per attempt
+	defaultCLIRetryDelay = time.Second
+
+	// cliWaitDelay bounds how long Wait waits for output pipes after the
+	// process exits or is killed (grandchildren may hold them open)
+	cliWaitDelay = 5 * time.Second
+)
+
+// cliAttempts is how often a subcommand is tried. Only idempotent ones are
+// retried after a failure or timeout; install-local and uninstall may have
+// half-applied.
+func cliAttempts(op string) int {
+	if op == "start" || op == "stop" || op == "list" {
+		return cliMaxAttempts
+	}
+	return 1
+}
+
+// InstallerOption configures optional Installer behaviour
+type InstallerOption func(*installerConfig)
+
+// WithCLITimeouts sets the per-operation deadlines (zero fields keep the
+// default); the API client applies them to its requests
+func WithCLITimeouts(t CLITimeouts) InstallerOption {
+	return func(c *installerConfig) {
+		c.timeouts = t
+	}
+}
+
+// command builds an appcenter-cli invocation bound to ctx. Cancelling ctx
+// kills the process group, so helpers spawned by the CLI die with it.
+func (i *CLIInstaller) command(ctx context.Context, dir string, op string, args ...string) *exec.Cmd {
+	cmd := exec.CommandContext(ctx, i.appcenterCLIPath, append([]string{op}, args...)...)
+	cmd.Dir = dir
+	cmd.Env = trace.Environ(ctx)
+	cmd.WaitDelay = cliWaitDelay
+	setProcessGroup(cmd)
+	return cmd
+}
+
+// runCLI runs appcenter-cli op args... in dir (if set), within the op's
+// deadline and retrying idempotent ops with backoff. Stdout and stderr share
+// one writer, so exec uses a single pipe and copy goroutine, and only the
+// last cliOutputLimit bytes are kept. A failure returns a *CLIError (also
+// logged with the output); success logs a one-line summary.
+func (i *CLIInstaller) runCLI(ctx context.Context, dir string, op string, args ...string) error {
+	return i.runCLIAttempts(ctx, cliAttempts(op), dir, op, args...)
+}
+
+// tryCLI runs appcenter-cli once, for best-effort calls whose failure is expected
+func (i *CLIInstaller) tryCLI(ctx context.Context, op string, args ...string) error {
+	return i.runCLIAttempts(ctx, 1, "", op, args...)
+}
+
+func (i *CLIInstaller) runCLIAttempts(ctx context.Context, attempts int, dir string, op string, args ...string) error {
+	out := getRingBuf()
+	defer ringBufPool.Put(out)
+
+	return i.retryCLI(ctx, op, attempts, func(ctx context.Context) error {
+		out.reset()
+		cmd := i.command(ctx, dir, op, args...)
+		cmd.Stdout = out
+		cmd.Stderr = out
+
+		if err := cmd.Run(); err != nil {
+			cliErr := &CLIError{Op: op, Err: i.timeoutError(ctx, op, err), Output: out.String()}
+			slog.WarnContext(ctx, "appcenter-cli failed", "op", op, "args", args, "error", cliErr.Err, "output", cliErr.Output)
+			return cliErr
+		}
+
+		slog.DebugContext(ctx, "appcenter-cli finished", "op", op, "args", args,
+			"output_bytes", out.total, "last_line", lastLine(out.Bytes()))
+		return nil
+	})
+}
+
+// outputCLI runs appcenter-cli op args... like runCLI but returns its stdout,
+// for subcommands whose output is parsed
+func (i *CLIInstaller) outputCLI(ctx context.Context, op string, args ...string) ([]byte, error) {
+	var output []byte
+	err := i.retryCLI(ctx, op, cliAttempts(op), func(ctx context.Context) error {
+		var err error
+		output, err = i.command(ctx, "", op, args...).Output()
+		if err != nil {
+			return &CLIError{Op: op, Err: i.timeoutError(ctx, op, err)}
+		}
+		return nil
+	})
+	return output, err
+}
+
+// retryCLI runs attempt under the op's deadline up to attempts times, with
+// exponential backoff. It gives up at once if the parent ctx is done.
+func (i *CLIInstaller) retryCLI(ctx context.Context, op string, attempts int, attempt func(ctx context.Context) error) error {
+	delay := orDefaultDuration(i.retryDelay, defaultCLIRetryDelay)
+	for n := 1; ; n++ {
+		attemptCtx, cancel := context.WithTimeout(ctx, i.timeouts.forOp(op))
+		err := attempt(attemptCtx)
+		cancel()
+		if err == nil || n >= attempts || ctx.Err() != nil {
+			return err
+		}
+
+		slog.WarnContext(ctx, "Retrying appcenter-cli", "op", op, "attempt", n+1, "delay", delay, "error", err)
+		select {
+		case <-ctx.Done():
+			return err
+		case <-time.After(delay):
+		}
+		delay *= 2
+	}
+}
+
+// timeoutError marks err as a timeout if the attempt's own deadline killed it
+func (i *CLIInstaller) timeoutError(ctx context.Context, op string, err error) error {
+	if errors.Is(ctx.Err(), context.DeadlineExceeded) {
+		return fmt.Errorf("%w after %s: %v", ErrCLITimeout, i.timeouts.forOp(op), err)
+	}
+	return err
+}
@@ -0,0 +1,110 @@
+package fpkgen
+
+import (
+	"bytes"
+	"fmt"
+	"strconv"
+	"sync"
+)
+
+// cliOutputLimit is how much appcenter-cli output (the tail) is kept per operation
+const cliOutputLimit = 16 << 10
+
+// cliSummaryLimit caps the output line logged for a successful operation
+const cliSummaryLimit = 200
+
+// ringBuffer keeps the last len(buf) bytes written to it
+type ringBuffer struct {
+	buf   []byte
+	pos   int   // Next write position once the buffer has wrapped
+	total int64 // Bytes written, including discarded ones
+}
+
+// ringBufPool recycles output buffers across appcenter-cli runs
+var ringBufPool = sync.Pool{
+	New: func() any { return &ringBuffer{buf: make([]byte, 0, cliOutputLimit)} },
+}
+
+func getRingBuf() *ringBuffer {
+	r := ringBufPool.Get().(*ringBuffer)
+	r.reset()
+	return r
+}
+
+// reset empties the buffer, keeping its capacity
+func (r *ringBuffer) reset() {
+	r.buf, r.pos, r.total = r.buf[:0], 0, 0
+}
+
+// Write implements io.Writer; it never fails
+func (r *ringBuffer) Write(p []byte) (int, error) {
+	n := len(p)
+	r.total += int64(n)
+	limit := cap(r.buf)
+
+	if len(p) >= limit {
+		// Only the tail of p survives
+		r.buf = append(r.buf[:0], p[len(p)-limit:]...)
+		r.pos = 0
+		return n, nil
+	}
+	if room := limit - len(r.buf); room > 0 {
+		k := min(room, len(p))
+		r.buf = append(r.buf, p[:k]...)
+		p = p[k:]
+	}
+	for len(p) > 0 {
+		k := copy(r.buf[r.pos:], p)
+		r.pos = (r.pos + k) % limit
+		p = p[k:]
+	}
+	return n, nil
+}
+
+// Bytes returns the retained output in write order
+func (r *ringBuffer) Bytes() []byte {
+	if r.pos == 0 {
+		return r.buf
+	}
+	out := make([]byte, 0, len(r.buf))
+	out = append(out, r.buf[r.pos:]...)
+	return append(out, r.buf[:r.pos]...)
+}
+
+// String returns the retained output, noting how much was dropped
+func (r *ringBuffer) String() string {
+	out := r.Bytes()
+	if dropped := r.total - int64(len(out)); dropped > 0 {
+		return "[" + strconv.FormatInt(dropped, 10) + " bytes truncated]\n" + string(out)
+	}
+	return string(out)
+}
+
+// lastLine returns the last non-blank line of output, capped at cliSummaryLimit
+func lastLine(out []byte) string {
+	out = bytes.TrimRight(out, " \t\r\n")
+	if i := bytes.LastIndexByte(out, '\n'); i >= 0 {
+		out = out[i+1:]
+	}
+	out = bytes.TrimSpace(out)
+	if len(out) > cliSummaryLimit {
+		out = out[:cliSummaryLimit]
+	}
+	return string(out)
+}
+
+// CLIError is a failed appcenter-cli run with the tail of its output
+type CLIError struct {
+	Op     string
+	Err    error
+	Output string
+}
+
+func (e *CLIError) Error() string {
+	if line := lastLine([]byte(e.Output)); line != "" {
+		return fmt.Sprintf("appcenter-cli %s: %v: %s", e.Op, e.Err, line)
+	}
+	return fmt.Sprintf("appcenter-cli %s: %v", e.Op, e.Err)
+}
+
+func (e *CLIError) Unwrap() error { return e.Err }
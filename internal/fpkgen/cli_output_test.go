@@ -0,0 +1,175 @@
+package fpkgen
+
+import (
+	"context"
+	"errors"
+	"os"
+	"os/exec"
+	"path/filepath"
+	"strings"
+	"testing"
+	"time"
+)
+
+// TestRingBuffer_KeepsTail tests that only the last bytes survive wrapping
+func TestRingBuffer_KeepsTail(t *testing.T) {
+	r := &ringBuffer{buf: make([]byte, 0, 8)}
+	r.Write([]byte("abc"))
+	r.Write([]byte("defgh"))
+	if got := string(r.Bytes()); got != "abcdefgh" {
+		t.Fatalf("Bytes() = %q, want %q", got, "abcdefgh")
+	}
+
+	r.Write([]byte("ijk"))
+	if got := string(r.Bytes()); got != "defghijk" {
+		t.Errorf("Bytes() after wrap = %q, want %q", got, "defghijk")
+	}
+	if got := r.String(); got != "[3 bytes truncated]\ndefghijk" {
+		t.Errorf("String() = %q", got)
+	}
+
+	// A single write larger than the buffer keeps its own tail
+	r.Write([]byte("0123456789"))
+	if got := string(r.Bytes()); got != "23456789" {
+		t.Errorf("Bytes() after large write = %q, want %q", got, "23456789")
+	}
+	if r.total != 21 {
+		t.Errorf("total = %d, want 21", r.total)
+	}
+}
+
+// TestLastLine tests the success summary line
+func TestLastLine(t *testing.T) {
+	if got := lastLine([]byte("step 1\nstep 2\n  done  \n\n")); got != "done" {
+		t.Errorf("lastLine() = %q, want %q", got, "done")
+	}
+	if got := lastLine(nil); got != "" {
+		t.Errorf("lastLine(nil) = %q", got)
+	}
+	if got := lastLine([]byte(strings.Repeat("x", 500))); len(got) != cliSummaryLimit {
+		t.Errorf("lastLine() length = %d, want %d", len(got), cliSummaryLimit)
+	}
+}
+
+// fakeCLI writes an executable shell script standing in for appcenter-cli
+func fakeCLI(t *testing.T, script string) *CLIInstaller {
+	t.Helper()
+	if _, err := exec.LookPath("sh"); err != nil {
+		t.Skip("sh not available")
+	}
+	path := filepath.Join(t.TempDir(), "appcenter-cli")
+	if err := os.WriteFile(path, []byte("#!/bin/sh\n"+script), 0755); err != nil {
+		t.Fatalf("Failed to write fake CLI: %v", err)
+	}
+	return &CLIInstaller{appcenterCLIPath: path, retryDelay: time.Millisecond}
+}
+
+// TestRunCLI_FailureCarriesOutput tests that a failed run returns its output tail
+func TestRunCLI_FailureCarriesOutput(t *testing.T) {
+	i := fakeCLI(t, `echo "starting $1"; echo "error: no such app" >&2; exit 3`)
+
+	err := i.StartApp(context.Background(), "watchcow.missing")
+	var cliErr *CLIError
+	if !errors.As(err, &cliErr) {
+		t.Fatalf("expected *CLIError, got %v", err)
+	}
+	if cliErr.Op != "start" {
+		t.Errorf("Op = %q, want start", cliErr.Op)
+	}
+	if cliErr.Output != "starting start\nerror: no such app\n" {
+		t.Errorf("Output = %q", cliErr.Output)
+	}
+	if !strings.Contains(err.Error(), "error: no such app") {
+		t.Errorf("Error() should include the last output line: %v", err)
+	}
+}
+
+// TestRunCLI_BoundsOutput tests that a chatty CLI cannot grow memory without limit
+func TestRunCLI_BoundsOutput(t *testing.T) {
+	i := fakeCLI(t, `i=0; while [ $i -lt 2000 ]; do echo "progress line $i padded to make it longer"; i=$((i+1)); done; exit 1`)
+
+	err := i.runCLI(context.Background(), "", "install-local")
+	var cliErr *CLIError
+	if !errors.As(err, &cliErr) {
+		t.Fatalf("expected *CLIError, got %v", err)
+	}
+	if !strings.HasPrefix(cliErr.Output, "[") || !strings.Contains(cliErr.Output, "bytes truncated]") {
+		t.Errorf("Output should note truncation, got prefix %q", cliErr.Output[:40])
+	}
+	if !strings.HasSuffix(cliErr.Output, "progress line 1999 padded to make it longer\n") {
+		t.Errorf("Output should end with the last line")
+	}
+	if len(cliErr.Output) > cliOutputLimit+64 {
+		t.Errorf("Output length %d exceeds limit %d", len(cliErr.Output), cliOutputLimit)
+	}
+}
+
+// TestRunCLI_Success tests a clean run and the working directory
+func TestRunCLI_Success(t *testing.T) {
+	i := fakeCLI(t, `test -f manifest || exit 1; echo installed`)
+	dir := t.TempDir()
+	if err := os.WriteFile(filepath.Join(dir, "manifest"), nil, 0644); err != nil {
+		t.Fatal(err)
+	}
+	if err := i.InstallLocal(context.Background(), dir); err != nil {
+		t.Errorf("InstallLocal failed: %v", err)
+	}
+}
+
+// TestRunCLI_TimeoutKillsProcessGroup tests that a hung CLI and the helpers it
+// spawned are killed at the deadline instead of blocking the worker
+func TestRunCLI_TimeoutKillsProcessGroup(t *testing.T) {
+	i := fakeCLI(t, `sleep 30 & sleep 30`)
+	i.timeouts = CLITimeouts{Install: 200 * time.Millisecond}
+
+	start := time.Now()
+	err := i.InstallLocal(context.Background(), t.TempDir())
+	if !errors.Is(err, ErrCLITimeout) {
+		t.Fatalf("expected ErrCLITimeout, got %v", err)
+	}
+	// The background sleep holds the output pipe; only a group kill frees it early
+	if elapsed := time.Since(start); elapsed > cliWaitDelay {
+		t.Errorf("InstallLocal took %v, want well under %v", elapsed, cliWaitDelay)
+	}
+}
+
+// TestRunCLI_RetriesIdempotentOps tests that start is retried after a transient failure
+func TestRunCLI_RetriesIdempotentOps(t *testing.T) {
+	counter := filepath.Join(t.TempDir(), "attempts")
+	i := fakeCLI(t, `echo x >> `+counter+`; [ $(wc -l < `+counter+`) -ge 2 ]`)
+
+	if err := i.StartApp(context.Background(), "watchcow.app"); err != nil {
+		t.Fatalf("StartApp failed after retry: %v", err)
+	}
+	if data, _ := os.ReadFile(counter); strings.Count(string(data), "x") != 2 {
+		t.Errorf("attempts = %d, want 2", strings.Count(string(data), "x"))
+	}
+}
+
+// TestRunCLI_NoRetryForInstall tests that install-local runs once even on failure
+func TestRunCLI_NoRetryForInstall(t *testing.T) {
+	counter := filepath.Join(t.TempDir(), "attempts")
+	i := fakeCLI(t, `echo x >> `+counter+`; exit 1`)
+
+	if err := i.InstallLocal(context.Background(), t.TempDir()); err == nil {
+		t.Fatal("expected InstallLocal to fail")
+	}
+	if data, _ := os.ReadFile(counter); strings.Count(string(data), "x") != 1 {
+		t.Errorf("attempts = %d, want 1", strings.Count(string(data), "x"))
+	}
+}
+
+// TestRunCLI_CancelStopsRetries tests that cancellation (e.g. Monitor.Stop) ends the run
+func TestRunCLI_CancelStopsRetries(t *testing.T) {
+	i := fakeCLI(t, `sleep 30`)
+	ctx, cancel := context.WithCancel(context.Background())
+	time.AfterFunc(100*time.Millisecond, cancel)
+
+	start := time.Now()
+	if err := i.StopApp(ctx, "watchcow.app"); err == nil {
+		t.Fatal("expected StopApp to fail when cancelled")
+	}
+	if elapsed := time.Since(start); elapsed > 2*time.Second {
+		t.Errorf("StopApp took %v after cancel", elapsed)
+	}
+}
@@ -558,3 +558,30 @@ func TestIsEntryField(t *testing.T) {
 		}
 	}
 }
+
+// TestParseEntries_NamedEntriesSorted tests that named entries come out in a stable, sorted order
+func TestParseEntries_NamedEntriesSorted(t *testing.T) {
+	labels := map[string]string{
+		"watchcow.service_port":             "8080",
+		"watchcow.control.access_perm":      "readonly",
+		"watchcow.zeta.service_port":        "8083",
+		"watchcow.alpha.service_port":       "8081",
+		"watchcow.mid.control.path_perm":    "hidden",
+		"com.docker.compose.project":        "demo",
+		"watchcow.alpha.unrelated_property": "ignored",
+	}
+
+	for i := 0; i < 10; i++ {
+		entries := parseEntries(labels, "Test App", "https://default.icon/icon.png", "9090")
+		var names []string
+		for _, e := range entries {
+			names = append(names, e.Name)
+		}
+		if len(names) != 4 || names[0] != "" || names[1] != "alpha" || names[2] != "mid" || names[3] != "zeta" {
+			t.Fatalf("expected [\"\" alpha mid zeta], got %q", names)
+		}
+		if entries[0].Control == nil || entries[0].Control.AccessPerm != "readonly" {
+			t.Errorf("expected default entry control from watchcow.control.access_perm, got %+v", entries[0].Control)
+		}
+	}
+}
@@ -43,7 +43,7 @@ func TestProperty_InvalidInputErrorHandling(t *testing.T) {
 		}
 
 		// loadLocalIcon should return an error for unknown format
-		_, err := loadLocalIcon(tmpFile)
+		_, err := loadLocalIcon(tmpFile, DefaultIconLimits)
 		if err == nil {
 			t.Logf("Expected error for invalid data (len=%d), got nil", len(data))
 			return false
@@ -78,7 +78,7 @@ func TestProperty_NonExistentFileError(t *testing.T) {
 		nonExistentPath := filepath.Join(tmpDir, "nonexistent_subdir", filename)
 
 		// loadLocalIcon should return an error for non-existent file
-		_, err := loadLocalIcon(nonExistentPath)
+		_, err := loadLocalIcon(nonExistentPath, DefaultIconLimits)
 		if err == nil {
 			t.Logf("Expected error for non-existent file %q, got nil", nonExistentPath)
 			return false
@@ -95,7 +95,7 @@ func TestProperty_NonExistentFileError(t *testing.T) {
 
 // TestLoadLocalIcon_NonExistentFile tests loadLocalIcon with a non-existent file
 func TestLoadLocalIcon_NonExistentFile(t *testing.T) {
-	_, err := loadLocalIcon("/nonexistent/path/to/icon.png")
+	_, err := loadLocalIcon("/nonexistent/path/to/icon.png", DefaultIconLimits)
 	if err == nil {
 		t.Error("Expected error for non-existent file, got nil")
 	}
@@ -114,7 +114,7 @@ func TestLoadLocalIcon_InvalidFormat(t *testing.T) {
 		t.Fatalf("Failed to write temp file: %v", err)
 	}
 
-	_, err := loadLocalIcon(tmpFile)
+	_, err := loadLocalIcon(tmpFile, DefaultIconLimits)
 	if err == nil {
 		t.Error("Expected error for invalid format, got nil")
 	}
@@ -131,7 +131,7 @@ func TestLoadLocalIcon_EmptyFile(t *testing.T) {
 		t.Fatalf("Failed to write temp file: %v", err)
 	}
 
-	_, err := loadLocalIcon(tmpFile)
+	_, err := loadLocalIcon(tmpFile, DefaultIconLimits)
 	if err == nil {
 		t.Error("Expected error for empty file, got nil")
 	}
@@ -148,7 +148,7 @@ func TestLoadLocalIcon_CorruptedICO(t *testing.T) {
 		t.Fatalf("Failed to write temp file: %v", err)
 	}
 
-	_, err := loadLocalIcon(tmpFile)
+	_, err := loadLocalIcon(tmpFile, DefaultIconLimits)
 	if err == nil {
 		t.Error("Expected error for corrupted ICO, got nil")
 	}
@@ -156,7 +156,7 @@ func TestLoadLocalIcon_CorruptedICO(t *testing.T) {
 
 // TestLoadIconFromSource_EmptySource tests loadIconFromSource with empty source
 func TestLoadIconFromSource_EmptySource(t *testing.T) {
-	_, err := loadIconFromSource("", "")
+	_, err := loadIconFromSource("", "", DefaultIconLimits)
 	if err == nil {
 		t.Error("Expected error for empty source, got nil")
 	}
@@ -167,7 +167,7 @@ func TestLoadIconFromSource_EmptySource(t *testing.T) {
 
 // TestLoadIconFromSource_UnsupportedScheme tests loadIconFromSource with unsupported scheme
 func TestLoadIconFromSource_UnsupportedScheme(t *testing.T) {
-	_, err := loadIconFromSource("ftp://example.com/icon.png", "")
+	_, err := loadIconFromSource("ftp://example.com/icon.png", "", DefaultIconLimits)
 	if err == nil {
 		t.Error("Expected error for unsupported scheme, got nil")
 	}
@@ -178,7 +178,7 @@ func TestLoadIconFromSource_UnsupportedScheme(t *testing.T) {
 
 // TestLoadIconFromSource_RelativePathNoBasePath tests loadIconFromSource with relative path but no basePath
 func TestLoadIconFromSource_RelativePathNoBasePath(t *testing.T) {
-	_, err := loadIconFromSource("file://icon.png", "")
+	_, err := loadIconFromSource("file://icon.png", "", DefaultIconLimits)
 	if err == nil {
 		t.Error("Expected error for relative path without basePath, got nil")
 	}
@@ -5,115 +5,219 @@ import (
 	"fmt"
 	"log/slog"
 	"os"
-	"path/filepath"
 	"strings"
-	"sync"
 
 	dockercontainer "github.com/docker/docker/api/types/container"
 	"github.com/docker/docker/client"
+
+	"watchcow/internal/trace"
 )
 
 // Generator handles fnOS application package generation from Docker containers
 type Generator struct {
-	dockerClient   *client.Client        // Docker API client
-	templateEngine *TemplateEngine       // Template engine for rendering
-	installed      map[string]*AppConfig // map[containerID]AppConfig - installed apps
-	mu             sync.RWMutex          // Protects installed map
+	dockerClient    *client.Client  // Docker API client
+	ownsClient      bool            // dockerClient was created by NewGenerator and is closed by Close
+	templateEngine  *TemplateEngine // Template engine for rendering
+	iconCache       *IconCache      // Persistent icon cache (nil = disabled)
+	iconConcurrency int             // Max concurrent icon fetch/resize jobs per package
+	iconLimits      IconLimits      // Size/pixel caps for a single icon
 }
 
-// NewGenerator creates a new application generator
-func NewGenerator() (*Generator, error) {
-	cli, err := client.NewClientWithOpts(client.FromEnv, client.WithAPIVersionNegotiation())
-	if err != nil {
-		return nil, fmt.Errorf("failed to create Docker client: %w", err)
+// GeneratorOption configures optional Generator behaviour
+type GeneratorOption func(*Generator)
+
+// WithDockerClient makes the generator use a shared Docker client instead of
+// creating its own. The caller keeps ownership: Close does not close it.
+func WithDockerClient(cli *client.Client) GeneratorOption {
+	return func(g *Generator) {
+		g.dockerClient = cli
 	}
+}
+
+// WithIconCache makes the generator reuse prepared icons from a persistent cache
+func WithIconCache(cache *IconCache) GeneratorOption {
+	return func(g *Generator) {
+		g.iconCache = cache
+	}
+}
+
+// WithIconConcurrency limits how many entry icons are fetched and resized in parallel
+func WithIconConcurrency(n int) GeneratorOption {
+	return func(g *Generator) {
+		if n > 0 {
+			g.iconConcurrency = n
+		}
+	}
+}
+
+// WithIconLimits caps the encoded size and pixel count of a single icon
+func WithIconLimits(limits IconLimits) GeneratorOption {
+	return func(g *Generator) {
+		g.iconLimits = limits
+	}
+}
 
+// NewGenerator creates a new application generator
+func NewGenerator(opts ...GeneratorOption) (*Generator, error) {
 	// Initialize template engine
 	tmplEngine, err := NewTemplateEngine()
 	if err != nil {
-		cli.Close()
 		return nil, fmt.Errorf("failed to create template engine: %w", err)
 	}
 
-	return &Generator{
-		dockerClient:   cli,
-		templateEngine: tmplEngine,
-		installed:      make(map[string]*AppConfig),
-	}, nil
+	g := &Generator{
+		templateEngine:  tmplEngine,
+		iconConcurrency: DefaultIconConcurrency,
+		iconLimits:      DefaultIconLimits,
+	}
+	for _, opt := range opts {
+		opt(g)
+	}
+
+	if g.dockerClient == nil {
+		cli, err := client.NewClientWithOpts(client.FromEnv, client.WithAPIVersionNegotiation())
+		if err != nil {
+			return nil, fmt.Errorf("failed to create Docker client: %w", err)
+		}
+		g.dockerClient = cli
+		g.ownsClient = true
+	}
+
+	return g, nil
 }
 
 // GenerateFromContainer creates fnOS app structure from a running container
 // Returns the config, temp directory path (caller should clean up after install)
 func (g *Generator) GenerateFromContainer(ctx context.Context, containerID string) (*AppConfig, string, error) {
 	// 1. Inspect container for full details
+	done := StartGeneratePhase(ctx, "inspect")
 	container, err := g.dockerClient.ContainerInspect(ctx, containerID)
+	done(err)
 	if err != nil {
 		return nil, "", fmt.Errorf("failed to inspect container: %w", err)
 	}
 
-	// 2. Extract configuration from container
-	config := g.extractConfig(&container)
+	return g.GenerateFromInspect(ctx, &container)
+}
 
-	// 3. Create temp directory for app package
-	appDir, err := os.MkdirTemp("", "watchcow-"+config.AppName+"-")
+// GenerateFromInspect is GenerateFromContainer for an already-fetched inspect result
+// Returns the config, temp directory path (caller should clean up after install)
+func (g *Generator) GenerateFromInspect(ctx context.Context, container *dockercontainer.InspectResponse) (*AppConfig, string, error) {
+	pkg, err := g.BuildFromInspect(ctx, container)
 	if err != nil {
-		return nil, "", fmt.Errorf("failed to create temp directory: %w", err)
+		return nil, "", err
 	}
-
-	if err := g.createDirectoryStructure(appDir); err != nil {
-		os.RemoveAll(appDir)
-		return nil, "", fmt.Errorf("failed to create directory structure: %w", err)
+	appDir, err := pkg.WriteTemp(ctx)
+	if err != nil {
+		return nil, "", err
 	}
+	return pkg.Config, appDir, nil
+}
 
-	// 4. Generate all files using templates
-	slog.Info("Generating fnOS app package", "appName", config.AppName, "container", config.ContainerName)
+// Package is a rendered app package held in memory. Config.PackageHash is
+// known before anything is written, so an unchanged package can be skipped.
+type Package struct {
+	Config *AppConfig
+	tree   *packageTree
+}
 
-	data := NewTemplateData(config)
+// BuildFromInspect extracts the configuration from an inspect result and
+// renders the package in memory
+func (g *Generator) BuildFromInspect(ctx context.Context, container *dockercontainer.InspectResponse) (*Package, error) {
+	// 2. Extract configuration from container
+	config := g.extractConfig(container)
 
-	if err := g.generateFromTemplates(appDir, data); err != nil {
-		return nil, "", err
-	}
+	// 3. Render all files in memory
+	slog.InfoContext(ctx, "Generating fnOS app package", "appName", config.AppName, "container", config.ContainerName)
 
-	if err := g.handleIcons(appDir, config); err != nil {
-		return nil, "", fmt.Errorf("failed to handle icons: %w", err)
+	tree, err := g.buildPackage(ctx, config)
+	if err != nil {
+		return nil, err
 	}
+	return &Package{Config: config, tree: tree}, nil
+}
 
-	slog.Info("Successfully generated fnOS app package", "appDir", appDir)
+// WriteTemp writes the package to a new temp directory in one pass and
+// returns its path (caller should clean up after install)
+func (p *Package) WriteTemp(ctx context.Context) (string, error) {
+	appDir, err := os.MkdirTemp("", "watchcow-"+p.Config.AppName+"-")
+	if err != nil {
+		return "", fmt.Errorf("failed to create temp directory: %w", err)
+	}
+	done := StartGeneratePhase(ctx, "write")
+	err = p.tree.writeTo(appDir)
+	done(err)
+	if err != nil {
+		os.RemoveAll(appDir)
+		return "", fmt.Errorf("failed to write package: %w", err)
+	}
 
-	return config, appDir, nil
+	slog.InfoContext(ctx, "Successfully generated fnOS app package", "appDir", appDir, "hash", shortHash(p.Config.PackageHash))
+	return appDir, nil
 }
 
 // GenerateFromConfig creates fnOS app structure from an AppConfig directly
 // This is useful for testing/debugging without needing a real Docker container
 func (g *Generator) GenerateFromConfig(config *AppConfig, appDir string) error {
+	ctx, span := trace.Start(context.Background(), "generate", "app", config.AppName)
+	var err error
+	defer func() { span.End(err) }()
+
+	// Generate all files in memory
+	slog.InfoContext(ctx, "Generating fnOS app package from config", "appName", config.AppName)
+
+	tree, err := g.buildPackage(ctx, config)
+	if err != nil {
+		return err
+	}
+
 	// Remove existing directory if exists
-	if err := os.RemoveAll(appDir); err != nil {
+	if err = os.RemoveAll(appDir); err != nil {
 		return fmt.Errorf("failed to remove existing directory: %w", err)
 	}
-
-	if err := g.createDirectoryStructure(appDir); err != nil {
-		return fmt.Errorf("failed to create directory structure: %w", err)
+	done := StartGeneratePhase(ctx, "write")
+	err = tree.writeTo(appDir)
+	done(err)
+	if err != nil {
+		return fmt.Errorf("failed to write package: %w", err)
 	}
 
-	// Generate all files using templates
-	slog.Info("Generating fnOS app package from config", "appName", config.AppName)
+	slog.InfoContext(ctx, "Successfully generated fnOS app package", "appDir", appDir, "hash", shortHash(config.PackageHash))
+	return nil
+}
 
+// buildPackage renders every file of the package into memory and records its
+// hash in config.PackageHash
+func (g *Generator) buildPackage(ctx context.Context, config *AppConfig) (*packageTree, error) {
 	data := NewTemplateData(config)
+	tree := newPackageTree()
 
-	if err := g.generateFromTemplates(appDir, data); err != nil {
-		return err
+	done := StartGeneratePhase(ctx, "templates")
+	err := g.generateFromTemplates(tree, data)
+	done(err)
+	if err != nil {
+		return nil, err
 	}
 
-	if err := g.handleIcons(appDir, config); err != nil {
-		return fmt.Errorf("failed to handle icons: %w", err)
+	done = StartGeneratePhase(ctx, "icons")
+	err = g.handleIcons(tree, config)
+	done(err)
+	if err != nil {
+		return nil, fmt.Errorf("failed to handle icons: %w", err)
 	}
 
-	slog.Info("Successfully generated fnOS app package", "appDir", appDir)
-	return nil
+	done = StartGeneratePhase(ctx, "hash")
+	hash, err := addPackageHash(tree, data)
+	done(err)
+	if err != nil {
+		return nil, err
+	}
+	config.PackageHash = hash
+	return tree, nil
 }
 
-// generateFromTemplates generates all files using template engine
-func (g *Generator) generateFromTemplates(appDir string, data *TemplateData) error {
+// generateFromTemplates renders all template files into the package tree
+func (g *Generator) generateFromTemplates(tree *packageTree, data *TemplateData) error {
 	// Define template -> file mappings
 	mappings := []struct {
 		template string
@@ -128,35 +232,40 @@ func (g *Generator) generateFromTemplates(appDir string, data *TemplateData) err
 	}
 
 	for _, m := range mappings {
-		filePath := filepath.Join(appDir, m.path)
-		if err := g.templateEngine.RenderToFile(m.template, filePath, data, m.perm); err != nil {
+		content, err := g.templateEngine.Render(m.template, data)
+		if err != nil {
 			return fmt.Errorf("failed to generate %s: %w", m.path, err)
 		}
+		tree.add(m.path, content, m.perm)
 	}
 
 	// Generate UI config JSON directly (not using template)
-	uiConfigPath := filepath.Join(appDir, "app", "ui", "config")
 	uiConfigJSON, err := GenerateUIConfigJSON(data)
 	if err != nil {
 		return fmt.Errorf("failed to generate UI config: %w", err)
 	}
-	if err := os.WriteFile(uiConfigPath, uiConfigJSON, 0644); err != nil {
-		return fmt.Errorf("failed to write UI config: %w", err)
-	}
+	tree.add("app/ui/config", uiConfigJSON, 0644)
 
-	// Generate empty cmd scripts
+	// Generate empty cmd scripts (identical, so rendered once)
+	empty, err := g.templateEngine.Render("cmd_empty.tmpl", data)
+	if err != nil {
+		return fmt.Errorf("failed to generate empty cmd scripts: %w", err)
+	}
 	cmdScripts := []string{"install_init", "install_callback", "uninstall_init", "uninstall_callback",
 		"upgrade_init", "upgrade_callback", "config_init", "config_callback"}
 	for _, script := range cmdScripts {
-		filePath := filepath.Join(appDir, "cmd", script)
-		if err := g.templateEngine.RenderToFile("cmd_empty.tmpl", filePath, data, 0755); err != nil {
-			return fmt.Errorf("failed to generate cmd/%s: %w", script, err)
-		}
+		tree.add("cmd/"+script, empty, 0755)
 	}
 
 	return nil
 }
 
+// ConfigFromInspect extracts the AppConfig GenerateFromInspect would use, for
+// tools that describe containers without a running daemon (e.g. compose files)
+func (g *Generator) ConfigFromInspect(container *dockercontainer.InspectResponse) *AppConfig {
+	return g.extractConfig(container)
+}
+
 // extractConfig extracts AppConfig from container inspection result
 // Label naming follows fnOS manifest conventions:
 //
@@ -172,28 +281,42 @@ func (g *Generator) generateFromTemplates(appDir string, data *TemplateData) err
 func (g *Generator) extractConfig(container *dockercontainer.InspectResponse) *AppConfig {
 	name := strings.TrimPrefix(container.Name, "/")
 	labels := container.Config.Labels
+	idx := indexLabels(labels)
+	top := &idx.defaultEntry
 
 	// Generate sanitized app name
-	sanitizedName := sanitizeAppName(name)
-	appName := getLabel(labels, "watchcow.appname", fmt.Sprintf("watchcow.%s", sanitizedName))
+	appName := idx.appName
+	if appName == "" {
+		appName = "watchcow." + sanitizeAppName(name)
+	}
 
-	defaultIcon := getLabel(labels, "watchcow.icon", guessIcon(container.Config.Image))
-	displayName := getLabel(labels, "watchcow.display_name", prettifyName(name))
+	defaultIcon := top.icon
+	if defaultIcon == "" {
+		defaultIcon = guessIcon(container.Config.Image)
+	}
+	displayName := idx.displayName
+	if displayName == "" {
+		displayName = prettifyName(name)
+	}
+	description := idx.desc
+	if description == "" {
+		description = "Docker container: " + container.Config.Image
+	}
 
 	config := &AppConfig{
 		AppName:       appName,
-		Version:       getLabel(labels, "watchcow.version", "1.0.0"),
+		Version:       orDefault(idx.version, "1.0.0"),
 		DisplayName:   displayName,
-		Description:   getLabel(labels, "watchcow.desc", fmt.Sprintf("Docker container: %s", container.Config.Image)),
-		Maintainer:    getLabel(labels, "watchcow.maintainer", "WatchCow"),
+		Description:   description,
+		Maintainer:    orDefault(idx.maintainer, "WatchCow"),
 		ContainerID:   container.ID[:12],
 		ContainerName: name,
 		Image:         container.Config.Image,
-		Protocol:      getLabel(labels, "watchcow.protocol", "http"),
-		Port:          getLabel(labels, "watchcow.service_port", ""),
-		Path:          getLabel(labels, "watchcow.path", "/"),
-		UIType:        getLabel(labels, "watchcow.ui_type", "url"),
-		AllUsers:      getLabel(labels, "watchcow.all_users", "true") == "true",
+		Protocol:      orDefault(top.protocol, "http"),
+		Port:          top.port,
+		Path:          orDefault(top.path, "/"),
+		UIType:        orDefault(top.uiType, "url"),
+		AllUsers:      orDefault(top.allUsers, "true") == "true",
 		Icon:          defaultIcon,
 		Environment:   filterEnvironment(container.Config.Env),
 		Labels:        labels,
@@ -205,7 +328,7 @@ func (g *Generator) extractConfig(container *dockercontainer.InspectResponse) *A
 	}
 
 	// Parse multi-entry configuration
-	config.Entries = parseEntries(labels, displayName, defaultIcon, config.Port)
+	config.Entries = idx.entries(displayName, defaultIcon, config.Port)
 
 	// If no entries configured, create a default entry for backward compatibility
 	if len(config.Entries) == 0 {
@@ -219,7 +342,7 @@ func (g *Generator) extractConfig(container *dockercontainer.InspectResponse) *A
 			AllUsers:  config.AllUsers,
 			Icon:      defaultIcon,
 			FileTypes: nil,
-			NoDisplay: getLabel(labels, "watchcow.no_display", "false") == "true",
+			NoDisplay: top.noDisplay == "true",
 			Control:   nil,
 		}}
 	}
@@ -244,67 +367,9 @@ func (g *Generator) extractConfig(container *dockercontainer.InspectResponse) *A
 	return config
 }
 
-// createDirectoryStructure creates all required directories
-func (g *Generator) createDirectoryStructure(appDir string) error {
-	dirs := []string{
-		appDir,
-		filepath.Join(appDir, "app", "ui", "images"),
-		filepath.Join(appDir, "cmd"),
-		filepath.Join(appDir, "config"),
-	}
-
-	for _, dir := range dirs {
-		if err := os.MkdirAll(dir, 0755); err != nil {
-			return err
-		}
-	}
-
-	return nil
-}
-
-// IsInstalled checks if a container has already been installed as fnOS app
-func (g *Generator) IsInstalled(containerID string) bool {
-	g.mu.RLock()
-	defer g.mu.RUnlock()
-	_, exists := g.installed[containerID]
-	return exists
-}
-
-// GetInstalledApp gets the installed app config for a container
-func (g *Generator) GetInstalledApp(containerID string) *AppConfig {
-	g.mu.RLock()
-	defer g.mu.RUnlock()
-	return g.installed[containerID]
-}
-
-// MarkInstalled marks a container as installed
-func (g *Generator) MarkInstalled(containerID string, config *AppConfig) {
-	g.mu.Lock()
-	defer g.mu.Unlock()
-	g.installed[containerID] = config
-}
-
-// MarkUninstalled removes a container from the installed list
-func (g *Generator) MarkUninstalled(containerID string) {
-	g.mu.Lock()
-	defer g.mu.Unlock()
-	delete(g.installed, containerID)
-}
-
-// GetAllInstalled returns all installed apps
-func (g *Generator) GetAllInstalled() map[string]*AppConfig {
-	g.mu.RLock()
-	defer g.mu.RUnlock()
-	result := make(map[string]*AppConfig)
-	for k, v := range g.installed {
-		result[k] = v
-	}
-	return result
-}
-
-// Close closes the Docker client
+// Close closes the Docker client if the generator created it
 func (g *Generator) Close() error {
-	if g.dockerClient != nil {
+	if g.dockerClient != nil && g.ownsClient {
 		return g.dockerClient.Close()
 	}
 	return nil
@@ -325,14 +390,6 @@ func sanitizeAppName(name string) string {
 	return result.String()
 }
 
-// getLabel gets a label value with fallback
-func getLabel(labels map[string]string, key, fallback string) string {
-	if val, ok := labels[key]; ok && val != "" {
-		return val
-	}
-	return fallback
-}
-
 // filterEnvironment removes sensitive/unwanted environment variables
 func filterEnvironment(env []string) []string {
 	var filtered []string
@@ -446,110 +503,11 @@ func isEntryField(field string) bool {
 
 // hasDefaultEntry checks if there's a default entry configuration in labels
 func hasDefaultEntry(labels map[string]string) bool {
-	_, hasPort := labels["watchcow.service_port"]
-	_, hasProtocol := labels["watchcow.protocol"]
-	_, hasPath := labels["watchcow.path"]
-	_, hasTitle := labels["watchcow.title"]
-	_, hasUIType := labels["watchcow.ui_type"]
-	return hasPort || hasProtocol || hasPath || hasTitle || hasUIType
-}
-
-// parseEntry parses a single entry from labels
-// name: entry name (empty string for default entry)
-// displayName: app display name for generating default title
-// defaultIcon: fallback icon URL
-func parseEntry(labels map[string]string, name string, displayName string, defaultIcon string) Entry {
-	prefix := "watchcow."
-	if name != "" {
-		prefix = "watchcow." + name + "."
-	}
-
-	// title default logic:
-	// - default entry: use display_name
-	// - named entry: use "display_name - entry_name"
-	title := getLabel(labels, prefix+"title", "")
-	if title == "" {
-		if name == "" {
-			title = displayName
-		} else {
-			title = displayName + " - " + name
-		}
-	}
-
-	// Parse file types (comma-separated list)
-	var fileTypes []string
-	if ft := getLabel(labels, prefix+"file_types", ""); ft != "" {
-		for _, t := range strings.Split(ft, ",") {
-			t = strings.TrimSpace(t)
-			if t != "" {
-				fileTypes = append(fileTypes, t)
-			}
-		}
-	}
-
-	// Parse control settings
-	var control *EntryControl
-	accessPerm := getLabel(labels, prefix+"control.access_perm", "")
-	portPerm := getLabel(labels, prefix+"control.port_perm", "")
-	pathPerm := getLabel(labels, prefix+"control.path_perm", "")
-	if accessPerm != "" || portPerm != "" || pathPerm != "" {
-		control = &EntryControl{
-			AccessPerm: accessPerm,
-			PortPerm:   portPerm,
-			PathPerm:   pathPerm,
-		}
-	}
-
-	return Entry{
-		Name:      name,
-		Title:     title,
-		Protocol:  getLabel(labels, prefix+"protocol", "http"),
-		Port:      getLabel(labels, prefix+"service_port", ""),
-		Path:      getLabel(labels, prefix+"path", "/"),
-		UIType:    getLabel(labels, prefix+"ui_type", "url"),
-		AllUsers:  getLabel(labels, prefix+"all_users", "true") == "true",
-		Icon:      getLabel(labels, prefix+"icon", defaultIcon),
-		FileTypes: fileTypes,
-		NoDisplay: getLabel(labels, prefix+"no_display", "false") == "true",
-		Control:   control,
-	}
+	return indexLabels(labels).hasDefault
 }
 
 // parseEntries extracts all entries from container labels
+// The default entry comes first, followed by named entries sorted by name.
 func parseEntries(labels map[string]string, displayName string, defaultIcon string, defaultPort string) []Entry {
-	entries := []Entry{}
-	entryNames := make(map[string]bool)
-
-	// Scan all labels to identify named entries
-	for key := range labels {
-		if !strings.HasPrefix(key, "watchcow.") {
-			continue
-		}
-
-		suffix := strings.TrimPrefix(key, "watchcow.")
-		parts := strings.SplitN(suffix, ".", 2)
-
-		// Check if this is a named entry field (e.g., "admin.service_port")
-		if len(parts) == 2 && isEntryField(parts[1]) {
-			entryNames[parts[0]] = true
-		}
-	}
-
-	// Check for default entry configuration
-	if hasDefaultEntry(labels) {
-		entry := parseEntry(labels, "", displayName, defaultIcon)
-		// Use container's first port as fallback if not specified
-		if entry.Port == "" {
-			entry.Port = defaultPort
-		}
-		entries = append(entries, entry)
-	}
-
-	// Parse named entries
-	for name := range entryNames {
-		entry := parseEntry(labels, name, displayName, defaultIcon)
-		entries = append(entries, entry)
-	}
-
-	return entries
+	return indexLabels(labels).entries(displayName, defaultIcon, defaultPort)
 }
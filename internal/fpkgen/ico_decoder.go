@@ -6,6 +6,7 @@ import (
 	"fmt"
 	"image"
 	"image/color"
+	"image/png"
 )
 
 // icoHeader represents the ICO file header (6 bytes)
@@ -43,15 +44,22 @@ func (e *icoEntry) getActualHeight() int {
 	return int(e.Height)
 }
 
-// resolution returns the total pixel count (width * height) for comparison
-func (e *icoEntry) resolution() int {
-	return e.getActualWidth() * e.getActualHeight()
-}
+// icoTargetSize is the rendition size decodeICO aims for: the largest icon we generate
+const icoTargetSize = 256
 
+// icoCandidate is a directory entry together with its embedded image data and
+// the dimensions read from that data
+type icoCandidate struct {
+	entry         *icoEntry
+	data          []byte // Sub-slice of the ICO file, not a copy
+	width, height int
+}
 
-// decodeICO decodes an ICO file and returns the highest resolution image.
+// decodeICO decodes an ICO file and returns the image closest to 256px
+// without going below it, or the largest image if none reaches 256px.
+// Images larger than limits allow are skipped before anything is decoded.
 // It supports both PNG and BMP encoded images within the ICO container.
-func decodeICO(data []byte) (image.Image, error) {
+func decodeICO(data []byte, limits IconLimits) (image.Image, error) {
 	if len(data) < 6 {
 		return nil, fmt.Errorf("invalid ICO file: too short for header")
 	}
@@ -80,9 +88,9 @@ func decodeICO(data []byte) (image.Image, error) {
 		return nil, fmt.Errorf("invalid ICO file: too short for directory entries")
 	}
 
-	// Parse directory entries and find the highest resolution image
-	var bestEntry *icoEntry
-	var bestResolution int
+	// Parse directory entries and rank them by their real dimensions
+	var best *icoCandidate
+	var limitErr error
 
 	for i := uint16(0); i < header.Count; i++ {
 		offset := 6 + int(i)*16
@@ -96,20 +104,63 @@ func decodeICO(data []byte) (image.Image, error) {
 			continue // Skip invalid entries
 		}
 
-		resolution := entry.resolution()
-		if bestEntry == nil || resolution > bestResolution {
-			bestEntry = entry
-			bestResolution = resolution
+		imageData := data[entry.Offset : entry.Offset+entry.Size]
+		width, height := icoImageSize(imageData, entry)
+		if err := limits.checkPixels(width, height); err != nil {
+			limitErr = err
+			continue
+		}
+		candidate := &icoCandidate{entry: entry, data: imageData, width: width, height: height}
+		if best == nil || candidate.betterThan(best) {
+			best = candidate
 		}
 	}
 
-	if bestEntry == nil {
+	if best == nil {
+		if limitErr != nil {
+			return nil, limitErr
+		}
 		return nil, fmt.Errorf("invalid ICO file: no valid image entries found")
 	}
 
-	// Extract and decode the best image
-	imageData := data[bestEntry.Offset : bestEntry.Offset+bestEntry.Size]
-	return decodeICOImage(imageData, bestEntry)
+	// Decode only the selected image
+	return decodeICOImage(best.data, best.entry)
+}
+
+// betterThan reports whether c is a better rendition than other for icoTargetSize:
+// images at least 256px beat smaller ones; among those the smallest wins,
+// otherwise the largest wins.
+func (c *icoCandidate) betterThan(other *icoCandidate) bool {
+	cFits := c.width >= icoTargetSize && c.height >= icoTargetSize
+	otherFits := other.width >= icoTargetSize && other.height >= icoTargetSize
+	if cFits != otherFits {
+		return cFits
+	}
+	if cFits {
+		return c.width*c.height < other.width*other.height
+	}
+	return c.width*c.height > other.width*other.height
+}
+
+// icoImageSize returns the dimensions of an embedded image without decoding it
+// PNG dimensions come from png.DecodeConfig, BMP dimensions from BITMAPINFOHEADER;
+// the directory entry is only used as a fallback since 0 there means "256 or more".
+func icoImageSize(data []byte, entry *icoEntry) (width, height int) {
+	if bytes.HasPrefix(data, magicPNG) {
+		if cfg, err := png.DecodeConfig(bytes.NewReader(data)); err == nil {
+			return cfg.Width, cfg.Height
+		}
+	} else if len(data) >= 12 {
+		width = int(int32(binary.LittleEndian.Uint32(data[4:8])))
+		height = int(int32(binary.LittleEndian.Uint32(data[8:12]))) / 2 // Includes AND mask
+		if height < 0 {
+			height = -height
+		}
+		if width > 0 && height > 0 {
+			return width, height
+		}
+	}
+	return entry.getActualWidth(), entry.getActualHeight()
 }
 
 // parseICOEntry parses a 16-byte ICO directory entry
@@ -126,7 +177,6 @@ func parseICOEntry(data []byte) *icoEntry {
 	}
 }
 
-
 // decodeICOImage decodes a single image from ICO data.
 // The image can be either PNG or BMP format.
 func decodeICOImage(data []byte, entry *icoEntry) (image.Image, error) {
@@ -136,7 +186,7 @@ func decodeICOImage(data []byte, entry *icoEntry) (image.Image, error) {
 
 	// Check if it's a PNG (starts with PNG signature)
 	if bytes.HasPrefix(data, magicPNG) {
-		img, _, err := image.Decode(bytes.NewReader(data))
+		img, err := png.Decode(bytes.NewReader(data))
 		if err != nil {
 			return nil, fmt.Errorf("failed to decode PNG in ICO: %w", err)
 		}
@@ -201,6 +251,13 @@ func decodeICOBMP(data []byte, entry *icoEntry) (image.Image, error) {
 		pixelOffset += paletteBytes
 	}
 
+	// 32-bit BMPs carry straight alpha, which maps onto NRGBA without conversion
+	if bitCount == 32 {
+		img := image.NewNRGBA(image.Rect(0, 0, width, height))
+		decodeICOBMP32(img, data[pixelOffset:], width, height)
+		return img, nil
+	}
+
 	// Create output image
 	img := image.NewRGBA(image.Rect(0, 0, width, height))
 
@@ -215,8 +272,6 @@ func decodeICOBMP(data []byte, entry *icoEntry) (image.Image, error) {
 		err = decodeICOBMP8(img, data[pixelOffset:], width, height, palette)
 	case 24:
 		err = decodeICOBMP24(img, data[pixelOffset:], width, height)
-	case 32:
-		err = decodeICOBMP32(img, data[pixelOffset:], width, height)
 	default:
 		return nil, fmt.Errorf("invalid ICO BMP: unsupported bit depth %d", bitCount)
 	}
@@ -228,7 +283,6 @@ func decodeICOBMP(data []byte, entry *icoEntry) (image.Image, error) {
 	return img, nil
 }
 
-
 // decodeICOBMP1 decodes 1-bit (monochrome) BMP data
 func decodeICOBMP1(img *image.RGBA, data []byte, width, height int, palette []uint8) error {
 	rowSize := ((width + 31) / 32) * 4 // Row size padded to 4 bytes
@@ -324,6 +378,7 @@ func decodeICOBMP8(img *image.RGBA, data []byte, width, height int, palette []ui
 }
 
 // decodeICOBMP24 decodes 24-bit (true color) BMP data
+// Rows are converted from bottom-up BGR straight into img.Pix
 func decodeICOBMP24(img *image.RGBA, data []byte, width, height int) error {
 	rowSize := ((width*3 + 3) / 4) * 4 // Row size padded to 4 bytes
 
@@ -335,40 +390,38 @@ func decodeICOBMP24(img *image.RGBA, data []byte, width, height int) error {
 			break
 		}
 
-		for x := 0; x < width; x++ {
-			pixelOffset := rowOffset + x*3
-			img.SetRGBA(x, y, color.RGBA{
-				B: data[pixelOffset],
-				G: data[pixelOffset+1],
-				R: data[pixelOffset+2],
-				A: 255,
-			})
+		src := data[rowOffset : rowOffset+width*3]
+		dst := img.Pix[y*img.Stride : y*img.Stride+width*4]
+		for s, d := 0, 0; d < len(dst); s, d = s+3, d+4 {
+			dst[d] = src[s+2]
+			dst[d+1] = src[s+1]
+			dst[d+2] = src[s]
+			dst[d+3] = 255
 		}
 	}
 	return nil
 }
 
 // decodeICOBMP32 decodes 32-bit (true color with alpha) BMP data
-func decodeICOBMP32(img *image.RGBA, data []byte, width, height int) error {
+// Rows are converted from bottom-up BGRA straight into img.Pix
+func decodeICOBMP32(img *image.NRGBA, data []byte, width, height int) {
 	rowSize := width * 4 // 32-bit is always aligned
 
 	for y := 0; y < height; y++ {
 		srcY := height - 1 - y // BMP is bottom-up
 		rowOffset := srcY * rowSize
 
-		if rowOffset+width*4 > len(data) {
+		if rowOffset+rowSize > len(data) {
 			break
 		}
 
-		for x := 0; x < width; x++ {
-			pixelOffset := rowOffset + x*4
-			img.SetRGBA(x, y, color.RGBA{
-				B: data[pixelOffset],
-				G: data[pixelOffset+1],
-				R: data[pixelOffset+2],
-				A: data[pixelOffset+3],
-			})
+		src := data[rowOffset : rowOffset+rowSize]
+		dst := img.Pix[y*img.Stride : y*img.Stride+rowSize]
+		for i := 0; i < rowSize; i += 4 {
+			dst[i] = src[i+2]
+			dst[i+1] = src[i+1]
+			dst[i+2] = src[i]
+			dst[i+3] = src[i+3]
 		}
 	}
-	return nil
 }
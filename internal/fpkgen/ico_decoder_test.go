@@ -6,6 +6,7 @@ import (
 	"image"
 	"image/color"
 	"image/png"
+	"strings"
 	"testing"
 	"testing/quick"
 )
@@ -13,8 +14,9 @@ import (
 // **Feature: icon-format-support, Property 2: ICO Highest Resolution Selection**
 // **Validates: Requirements 1.4, 2.2**
 //
-// For any valid ICO file containing multiple images of different resolutions,
+// For any valid ICO file containing multiple images of different resolutions below 256px,
 // the decodeICO function SHALL return the image with the largest pixel dimensions (width × height).
+// (Above 256px the smallest image of at least 256px wins, see TestDecodeICO_PrefersSmallestAtLeast256.)
 
 // generateICOWithPNGImages creates a valid ICO file with multiple PNG images of different sizes
 func generateICOWithPNGImages(sizes []int) ([]byte, int) {
@@ -72,10 +74,10 @@ func generateICOWithPNGImages(sizes []int) ([]byte, int) {
 		entryOffset := headerSize + i*16
 		pngData := pngDataList[i]
 
-		// Width and Height (0 means 256)
+		// Width and Height (0 means 256 or larger)
 		width := uint8(size)
 		height := uint8(size)
-		if size == 256 {
+		if size >= 256 {
 			width = 0
 			height = 0
 		}
@@ -98,8 +100,9 @@ func generateICOWithPNGImages(sizes []int) ([]byte, int) {
 }
 
 
-// TestProperty_ICOHighestResolutionSelection tests that decodeICO always returns the highest resolution image
-// Property 2: For any valid ICO file containing multiple images of different resolutions,
+// TestProperty_ICOHighestResolutionSelection tests that decodeICO returns the largest image
+// when none reaches 256px (otherwise the smallest image of at least 256px wins)
+// Property 2: For any valid ICO file containing multiple images of different resolutions below 256px,
 // the decodeICO function SHALL return the image with the largest pixel dimensions (width × height).
 func TestProperty_ICOHighestResolutionSelection(t *testing.T) {
 	f := func(sizesInput []uint8) bool {
@@ -135,7 +138,7 @@ func TestProperty_ICOHighestResolutionSelection(t *testing.T) {
 			return true // Skip invalid input
 		}
 
-		img, err := decodeICO(icoData)
+		img, err := decodeICO(icoData, IconLimits{})
 		if err != nil {
 			t.Logf("decodeICO failed: %v", err)
 			return false
@@ -165,7 +168,7 @@ func TestDecodeICO_SingleImage(t *testing.T) {
 	sizes := []int{64}
 	icoData, _ := generateICOWithPNGImages(sizes)
 
-	img, err := decodeICO(icoData)
+	img, err := decodeICO(icoData, IconLimits{})
 	if err != nil {
 		t.Fatalf("decodeICO failed: %v", err)
 	}
@@ -181,7 +184,7 @@ func TestDecodeICO_MultipleImages(t *testing.T) {
 	sizes := []int{16, 32, 48, 64, 128}
 	icoData, _ := generateICOWithPNGImages(sizes)
 
-	img, err := decodeICO(icoData)
+	img, err := decodeICO(icoData, IconLimits{})
 	if err != nil {
 		t.Fatalf("decodeICO failed: %v", err)
 	}
@@ -193,6 +196,94 @@ func TestDecodeICO_MultipleImages(t *testing.T) {
 	}
 }
 
+// TestDecodeICO_PrefersSmallestAtLeast256 tests that decodeICO picks the image closest
+// to 256px without going below it, using the embedded PNG dimensions
+func TestDecodeICO_PrefersSmallestAtLeast256(t *testing.T) {
+	tests := []struct {
+		sizes    []int
+		expected int
+	}{
+		{[]int{16, 256, 512}, 256},
+		{[]int{512, 32, 300}, 300},
+		{[]int{1024, 512}, 512},
+		{[]int{48, 128, 64}, 128}, // Nothing reaches 256: largest wins
+	}
+
+	for _, tt := range tests {
+		icoData, _ := generateICOWithPNGImages(tt.sizes)
+		img, err := decodeICO(icoData, IconLimits{})
+		if err != nil {
+			t.Fatalf("decodeICO(%v) failed: %v", tt.sizes, err)
+		}
+		if img.Bounds().Dx() != tt.expected || img.Bounds().Dy() != tt.expected {
+			t.Errorf("decodeICO(%v): expected %dx%d, got %v", tt.sizes, tt.expected, tt.expected, img.Bounds())
+		}
+	}
+}
+
+// TestDecodeICO_PixelLimit tests that images over the pixel limit are
+// skipped by their declared size instead of being decoded
+func TestDecodeICO_PixelLimit(t *testing.T) {
+	limits := IconLimits{MaxPixels: 256 * 256}
+
+	icoData, _ := generateICOWithPNGImages([]int{32, 1024})
+	img, err := decodeICO(icoData, limits)
+	if err != nil {
+		t.Fatalf("decodeICO failed: %v", err)
+	}
+	if img.Bounds().Dx() != 32 {
+		t.Errorf("expected the 32px image within the limit, got %v", img.Bounds())
+	}
+
+	icoData, _ = generateICOWithPNGImages([]int{1024})
+	if _, err := decodeICO(icoData, limits); err == nil || !strings.Contains(err.Error(), "exceeds limit") {
+		t.Errorf("expected a pixel limit error, got %v", err)
+	}
+}
+
+// TestDecodeICO_BMP32 tests that 32-bit BMP rows are flipped and converted from BGRA
+func TestDecodeICO_BMP32(t *testing.T) {
+	const w, h = 2, 2
+	dib := make([]byte, 40+w*h*4)
+	binary.LittleEndian.PutUint32(dib[0:4], 40)
+	binary.LittleEndian.PutUint32(dib[4:8], w)
+	binary.LittleEndian.PutUint32(dib[8:12], h*2) // Height includes AND mask
+	binary.LittleEndian.PutUint16(dib[12:14], 1)
+	binary.LittleEndian.PutUint16(dib[14:16], 32)
+	// Bottom row first: blue, green; top row: red, half-transparent white
+	copy(dib[40:], []byte{
+		255, 0, 0, 255, 0, 255, 0, 255,
+		0, 0, 255, 255, 255, 255, 255, 128,
+	})
+
+	ico := make([]byte, 6+16)
+	binary.LittleEndian.PutUint16(ico[2:4], 1)
+	binary.LittleEndian.PutUint16(ico[4:6], 1)
+	ico[6], ico[7] = w, h
+	binary.LittleEndian.PutUint16(ico[12:14], 32)
+	binary.LittleEndian.PutUint32(ico[14:18], uint32(len(dib)))
+	binary.LittleEndian.PutUint32(ico[18:22], 22)
+	ico = append(ico, dib...)
+
+	img, err := decodeICO(ico, IconLimits{})
+	if err != nil {
+		t.Fatalf("decodeICO failed: %v", err)
+	}
+
+	expected := map[image.Point]color.NRGBA{
+		{0, 0}: {R: 255, A: 255},
+		{1, 0}: {R: 255, G: 255, B: 255, A: 128},
+		{0, 1}: {B: 255, A: 255},
+		{1, 1}: {G: 255, A: 255},
+	}
+	for pt, want := range expected {
+		got := color.NRGBAModel.Convert(img.At(pt.X, pt.Y)).(color.NRGBA)
+		if got != want {
+			t.Errorf("pixel %v: expected %v, got %v", pt, want, got)
+		}
+	}
+}
+
 // TestDecodeICO_InvalidHeader tests error handling for invalid ICO header
 func TestDecodeICO_InvalidHeader(t *testing.T) {
 	tests := []struct {
@@ -207,7 +298,7 @@ func TestDecodeICO_InvalidHeader(t *testing.T) {
 
 	for _, tt := range tests {
 		t.Run(tt.name, func(t *testing.T) {
-			_, err := decodeICO(tt.data)
+			_, err := decodeICO(tt.data, IconLimits{})
 			if err == nil {
 				t.Error("expected error for invalid ICO header")
 			}
@@ -219,7 +310,7 @@ func TestDecodeICO_InvalidHeader(t *testing.T) {
 func TestDecodeICO_TruncatedDirectory(t *testing.T) {
 	// Header says 1 image, but no directory entry
 	data := []byte{0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x10} // Only 7 bytes, need 22 for header + 1 entry
-	_, err := decodeICO(data)
+	_, err := decodeICO(data, IconLimits{})
 	if err == nil {
 		t.Error("expected error for truncated directory")
 	}
@@ -248,23 +339,3 @@ func TestIcoEntry_GetActualDimensions(t *testing.T) {
 		}
 	}
 }
-
-// TestIcoEntry_Resolution tests the resolution calculation
-func TestIcoEntry_Resolution(t *testing.T) {
-	tests := []struct {
-		width, height uint8
-		expected      int
-	}{
-		{0, 0, 256 * 256},     // 0 means 256
-		{16, 16, 16 * 16},
-		{32, 32, 32 * 32},
-		{64, 128, 64 * 128},
-	}
-
-	for _, tt := range tests {
-		entry := &icoEntry{Width: tt.width, Height: tt.height}
-		if got := entry.resolution(); got != tt.expected {
-			t.Errorf("resolution() for %dx%d = %d, want %d", tt.width, tt.height, got, tt.expected)
-		}
-	}
-}
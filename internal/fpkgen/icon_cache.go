@@ -0,0 +1,321 @@
+package fpkgen
+
+import (
+	"crypto/sha256"
+	"encoding/hex"
+	"encoding/json"
+	"fmt"
+	"log/slog"
+	"os"
+	"path/filepath"
+	"strings"
+	"time"
+)
+
+// DefaultIconCacheTTL is how long a cached remote icon is used without revalidation
+const DefaultIconCacheTTL = 24 * time.Hour
+
+// iconCacheVersion identifies how renditions are produced. Bump it whenever
+// resizing or encoding changes, so entries from older builds are re-prepared.
+const iconCacheVersion = 1
+
+// iconBlobGrace keeps unreferenced blobs this young, since another process
+// sharing the cache may have written them before their entry
+const iconBlobGrace = time.Hour
+
+// IconCache is a persistent, content-addressed store of prepared icons.
+//
+// Layout:
+//
+//	<dir>/sources/<sha256(source)>.json  -> iconCacheEntry (validators + blob references)
+//	<dir>/blobs/<sha256(png)>.png        -> PNG-encoded 64x64 / 256x256 renditions
+//
+// Remote icons are used without any network access while younger than ttl,
+// and revalidated with ETag / Last-Modified afterwards. Local icons are
+// revalidated by file size and modification time on every lookup.
+// Entries from another iconCacheVersion and blobs no entry references are
+// deleted when the cache is opened.
+type IconCache struct {
+	dir string
+	ttl time.Duration
+}
+
+// iconCacheEntry is the on-disk metadata for one icon source
+type iconCacheEntry struct {
+	Version      int       `json:"version"` // iconCacheVersion that produced the blobs
+	Source       string    `json:"source"`
+	ETag         string    `json:"etag,omitempty"`
+	LastModified string    `json:"last_modified,omitempty"`
+	ModTime      int64     `json:"mod_time,omitempty"` // Local files: source mtime (UnixNano)
+	Size         int64     `json:"size,omitempty"`     // Local files: source size in bytes
+	CheckedAt    time.Time `json:"checked_at"`
+	Icon64       string    `json:"icon_64"`  // Blob hash of the 64x64 PNG
+	Icon256      string    `json:"icon_256"` // Blob hash of the 256x256 PNG
+}
+
+// NewIconCache creates (or reopens) an icon cache rooted at dir
+func NewIconCache(dir string, ttl time.Duration) (*IconCache, error) {
+	for _, sub := range []string{"sources", "blobs"} {
+		if err := os.MkdirAll(filepath.Join(dir, sub), 0755); err != nil {
+			return nil, fmt.Errorf("failed to create icon cache directory: %w", err)
+		}
+	}
+	c := &IconCache{dir: dir, ttl: ttl}
+	c.prune()
+	return c, nil
+}
+
+// prune deletes outdated or unreadable entries and the blobs no remaining
+// entry references. Failures are ignored like other cache write failures.
+func (c *IconCache) prune() {
+	referenced := make(map[string]bool)
+	sources, _ := os.ReadDir(filepath.Join(c.dir, "sources"))
+	for _, f := range sources {
+		path := filepath.Join(c.dir, "sources", f.Name())
+		if !strings.HasSuffix(f.Name(), ".json") {
+			removeIfOld(path)
+			continue
+		}
+		var entry iconCacheEntry
+		data, err := os.ReadFile(path)
+		if err == nil {
+			err = json.Unmarshal(data, &entry)
+		}
+		if err != nil || entry.Version != iconCacheVersion {
+			os.Remove(path)
+			continue
+		}
+		referenced[entry.Icon64] = true
+		referenced[entry.Icon256] = true
+	}
+
+	blobs, _ := os.ReadDir(filepath.Join(c.dir, "blobs"))
+	pruned := 0
+	for _, f := range blobs {
+		if referenced[strings.TrimSuffix(f.Name(), ".png")] {
+			continue
+		}
+		if removeIfOld(filepath.Join(c.dir, "blobs", f.Name())) {
+			pruned++
+		}
+	}
+	if pruned > 0 {
+		slog.Debug("Pruned unreferenced icon cache blobs", "count", pruned)
+	}
+}
+
+// removeIfOld deletes path unless it was modified within iconBlobGrace
+func removeIfOld(path string) bool {
+	info, err := os.Stat(path)
+	if err != nil || time.Since(info.ModTime()) < iconBlobGrace {
+		return false
+	}
+	return os.Remove(path) == nil
+}
+
+// load returns the prepared icon for a source, consulting the cache first
+// basePath: the base directory for resolving relative file:// paths (compose working directory)
+func (c *IconCache) load(iconSource string, basePath string, limits IconLimits) (*preparedIcon, error) {
+	if iconSource == "" {
+		return nil, fmt.Errorf("empty icon source")
+	}
+
+	if strings.HasPrefix(iconSource, "file://") {
+		localPath, err := resolveFilePath(iconSource, basePath)
+		if err != nil {
+			return nil, fmt.Errorf("failed to resolve file path: %w", err)
+		}
+		return c.loadLocal(localPath, limits)
+	} else if strings.HasPrefix(iconSource, "http") {
+		return c.loadRemote(iconSource, limits)
+	}
+
+	return nil, fmt.Errorf("unsupported icon source: %s", iconSource)
+}
+
+// loadLocal returns the prepared icon for a local file, reusing the cached
+// renditions while the file size and modification time are unchanged
+func (c *IconCache) loadLocal(path string, limits IconLimits) (*preparedIcon, error) {
+	info, err := os.Stat(path)
+	if err != nil {
+		return nil, fmt.Errorf("file not found: %s", path)
+	}
+
+	key := "file://" + path
+	entry, cached := c.lookup(key)
+	if cached != nil && entry.ModTime == info.ModTime().UnixNano() && entry.Size == info.Size() {
+		iconCacheLookups.Inc("hit")
+		return cached, nil
+	}
+	iconCacheLookups.Inc("miss")
+
+	img, err := loadLocalIcon(path, limits)
+	if err != nil {
+		return nil, err
+	}
+	icon, err := encodePreparedIcon(img)
+	if err != nil {
+		return nil, err
+	}
+
+	c.store(key, &iconCacheEntry{
+		ModTime:   info.ModTime().UnixNano(),
+		Size:      info.Size(),
+		CheckedAt: time.Now(),
+	}, icon)
+	return icon, nil
+}
+
+// loadRemote returns the prepared icon for a URL. Fresh entries skip the
+// network entirely; stale entries are revalidated with a conditional GET.
+func (c *IconCache) loadRemote(url string, limits IconLimits) (*preparedIcon, error) {
+	entry, cached := c.lookup(url)
+	if cached != nil && time.Since(entry.CheckedAt) < c.ttl {
+		iconCacheLookups.Inc("hit")
+		return cached, nil
+	}
+
+	var prev iconValidators
+	if cached != nil {
+		prev = iconValidators{ETag: entry.ETag, LastModified: entry.LastModified}
+	}
+
+	img, next, notModified, err := downloadIconConditional(url, prev, limits)
+	if err != nil {
+		if cached != nil {
+			slog.Warn("Failed to revalidate icon, using cached copy", "url", url, "error", err)
+			iconCacheLookups.Inc("stale")
+			return cached, nil
+		}
+		iconCacheLookups.Inc("miss")
+		return nil, err
+	}
+
+	if notModified && cached != nil {
+		iconCacheLookups.Inc("revalidated")
+		entry.CheckedAt = time.Now()
+		if err := c.writeEntry(url, entry); err != nil {
+			slog.Debug("Failed to update icon cache entry", "url", url, "error", err)
+		}
+		return cached, nil
+	}
+
+	iconCacheLookups.Inc("miss")
+	icon, err := encodePreparedIcon(img)
+	if err != nil {
+		return nil, err
+	}
+
+	c.store(url, &iconCacheEntry{
+		ETag:         next.ETag,
+		LastModified: next.LastModified,
+		CheckedAt:    time.Now(),
+	}, icon)
+	return icon, nil
+}
+
+// lookup reads the cache entry and its blobs for a source key
+// Returns nil icon if the entry is missing or incomplete
+func (c *IconCache) lookup(key string) (*iconCacheEntry, *preparedIcon) {
+	data, err := os.ReadFile(c.entryPath(key))
+	if err != nil {
+		return nil, nil
+	}
+
+	var entry iconCacheEntry
+	if err := json.Unmarshal(data, &entry); err != nil || entry.Source != key || entry.Version != iconCacheVersion {
+		return nil, nil
+	}
+
+	png64, err := os.ReadFile(c.blobPath(entry.Icon64))
+	if err != nil {
+		return nil, nil
+	}
+	png256, err := os.ReadFile(c.blobPath(entry.Icon256))
+	if err != nil {
+		return nil, nil
+	}
+
+	return &entry, &preparedIcon{png64: png64, png256: png256}
+}
+
+// store writes the icon blobs and then the entry referencing them
+// Failures are logged and otherwise ignored: the cache is an optimization only
+func (c *IconCache) store(key string, entry *iconCacheEntry, icon *preparedIcon) {
+	var err error
+	if entry.Icon64, err = c.writeBlob(icon.png64); err == nil {
+		if entry.Icon256, err = c.writeBlob(icon.png256); err == nil {
+			err = c.writeEntry(key, entry)
+		}
+	}
+	if err != nil {
+		slog.Debug("Failed to store icon in cache", "source", key, "error", err)
+	}
+}
+
+// writeBlob stores PNG bytes under their content hash and returns the hash
+func (c *IconCache) writeBlob(data []byte) (string, error) {
+	hash := hashHex(data)
+	path := c.blobPath(hash)
+	if _, err := os.Stat(path); err == nil {
+		// Refresh the mtime so a concurrent prune in another process keeps it
+		now := time.Now()
+		os.Chtimes(path, now, now)
+		return hash, nil
+	}
+	return hash, WriteFileAtomic(path, data, 0644)
+}
+
+// writeEntry stores the metadata for a source key
+func (c *IconCache) writeEntry(key string, entry *iconCacheEntry) error {
+	entry.Version = iconCacheVersion
+	entry.Source = key
+	data, err := json.Marshal(entry)
+	if err != nil {
+		return err
+	}
+	return WriteFileAtomic(c.entryPath(key), data, 0644)
+}
+
+func (c *IconCache) entryPath(key string) string {
+	return filepath.Join(c.dir, "sources", hashHex([]byte(key))+".json")
+}
+
+func (c *IconCache) blobPath(hash string) string {
+	return filepath.Join(c.dir, "blobs", hash+".png")
+}
+
+// hashHex returns the hex-encoded SHA-256 of data
+func hashHex(data []byte) string {
+	sum := sha256.Sum256(data)
+	return hex.EncodeToString(sum[:])
+}
+
+// WriteFileAtomic writes data to a temp file in the target directory and renames it into place,
+// so readers see either the old or the new content
+func WriteFileAtomic(path string, data []byte, perm os.FileMode) error {
+	f, err := os.CreateTemp(filepath.Dir(path), ".tmp-"+filepath.Base(path)+"-")
+	if err != nil {
+		return err
+	}
+	tmpPath := f.Name()
+
+	if _, err := f.Write(data); err != nil {
+		f.Close()
+		os.Remove(tmpPath)
+		return err
+	}
+	if err := f.Close(); err != nil {
+		os.Remove(tmpPath)
+		return err
+	}
+	if err := os.Chmod(tmpPath, perm); err != nil {
+		os.Remove(tmpPath)
+		return err
+	}
+	if err := os.Rename(tmpPath, path); err != nil {
+		os.Remove(tmpPath)
+		return err
+	}
+	return nil
+}
@@ -0,0 +1,204 @@
+package fpkgen
+
+import (
+	"bytes"
+	"encoding/json"
+	"image"
+	"image/color"
+	"image/png"
+	"net/http"
+	"net/http/httptest"
+	"os"
+	"path/filepath"
+	"sync/atomic"
+	"testing"
+	"time"
+)
+
+// encodeTestPNG returns a solid-color PNG of the given size
+func encodeTestPNG(t testing.TB, size int, c color.Color) []byte {
+	t.Helper()
+	img := image.NewRGBA(image.Rect(0, 0, size, size))
+	for y := 0; y < size; y++ {
+		for x := 0; x < size; x++ {
+			img.Set(x, y, c)
+		}
+	}
+	var buf bytes.Buffer
+	if err := png.Encode(&buf, img); err != nil {
+		t.Fatalf("Failed to encode PNG: %v", err)
+	}
+	return buf.Bytes()
+}
+
+// newETagServer serves data with an ETag and counts full (200) and conditional (304) responses
+func newETagServer(data []byte, full, notModified *int32) *httptest.Server {
+	return httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		w.Header().Set("ETag", `"v1"`)
+		if r.Header.Get("If-None-Match") == `"v1"` {
+			atomic.AddInt32(notModified, 1)
+			w.WriteHeader(http.StatusNotModified)
+			return
+		}
+		atomic.AddInt32(full, 1)
+		w.Write(data)
+	}))
+}
+
+// TestIconCache_RemoteFreshHitSkipsNetwork tests that fresh entries are served without any request
+func TestIconCache_RemoteFreshHitSkipsNetwork(t *testing.T) {
+	var full, notModified int32
+	srv := newETagServer(encodeTestPNG(t, 128, color.RGBA{R: 255, A: 255}), &full, &notModified)
+	defer srv.Close()
+
+	cache, err := NewIconCache(t.TempDir(), time.Hour)
+	if err != nil {
+		t.Fatalf("NewIconCache failed: %v", err)
+	}
+
+	first, err := cache.load(srv.URL+"/icon.png", "", DefaultIconLimits)
+	if err != nil {
+		t.Fatalf("first load failed: %v", err)
+	}
+	second, err := cache.load(srv.URL+"/icon.png", "", DefaultIconLimits)
+	if err != nil {
+		t.Fatalf("second load failed: %v", err)
+	}
+
+	if full != 1 || notModified != 0 {
+		t.Errorf("expected 1 download and 0 revalidations, got %d and %d", full, notModified)
+	}
+	if !bytes.Equal(first.png256, second.png256) || !bytes.Equal(first.png64, second.png64) {
+		t.Error("cached icon differs from freshly prepared icon")
+	}
+}
+
+// TestIconCache_RemoteStaleRevalidates tests that stale entries are revalidated with If-None-Match
+func TestIconCache_RemoteStaleRevalidates(t *testing.T) {
+	var full, notModified int32
+	srv := newETagServer(encodeTestPNG(t, 128, color.RGBA{G: 255, A: 255}), &full, &notModified)
+	defer srv.Close()
+
+	dir := t.TempDir()
+	cache, err := NewIconCache(dir, 0)
+	if err != nil {
+		t.Fatalf("NewIconCache failed: %v", err)
+	}
+
+	if _, err := cache.load(srv.URL+"/icon.png", "", DefaultIconLimits); err != nil {
+		t.Fatalf("first load failed: %v", err)
+	}
+
+	// Reopen to make sure state is read back from disk
+	cache, err = NewIconCache(dir, 0)
+	if err != nil {
+		t.Fatalf("NewIconCache failed: %v", err)
+	}
+	icon, err := cache.load(srv.URL+"/icon.png", "", DefaultIconLimits)
+	if err != nil {
+		t.Fatalf("second load failed: %v", err)
+	}
+
+	if full != 1 || notModified != 1 {
+		t.Errorf("expected 1 download and 1 revalidation, got %d and %d", full, notModified)
+	}
+	if len(icon.png64) == 0 || len(icon.png256) == 0 {
+		t.Error("expected cached icon bytes after 304")
+	}
+}
+
+// TestIconCache_LocalFileChangeInvalidates tests that a modified local file is re-prepared
+func TestIconCache_LocalFileChangeInvalidates(t *testing.T) {
+	srcDir := t.TempDir()
+	iconPath := filepath.Join(srcDir, "icon.png")
+	if err := os.WriteFile(iconPath, encodeTestPNG(t, 64, color.RGBA{B: 255, A: 255}), 0644); err != nil {
+		t.Fatalf("Failed to write icon: %v", err)
+	}
+
+	cache, err := NewIconCache(t.TempDir(), time.Hour)
+	if err != nil {
+		t.Fatalf("NewIconCache failed: %v", err)
+	}
+
+	first, err := cache.load("file://"+iconPath, "", DefaultIconLimits)
+	if err != nil {
+		t.Fatalf("first load failed: %v", err)
+	}
+
+	// Rewrite with different content and a different modification time
+	if err := os.WriteFile(iconPath, encodeTestPNG(t, 32, color.RGBA{R: 255, G: 255, A: 255}), 0644); err != nil {
+		t.Fatalf("Failed to rewrite icon: %v", err)
+	}
+	later := time.Now().Add(time.Minute)
+	if err := os.Chtimes(iconPath, later, later); err != nil {
+		t.Fatalf("Chtimes failed: %v", err)
+	}
+
+	second, err := cache.load("file://"+iconPath, "", DefaultIconLimits)
+	if err != nil {
+		t.Fatalf("second load failed: %v", err)
+	}
+	if bytes.Equal(first.png256, second.png256) {
+		t.Error("expected modified file to produce a different icon")
+	}
+}
+
+// TestIconCache_PruneAndVersion tests that reopening the cache drops entries
+// from another rendition version and old unreferenced blobs
+func TestIconCache_PruneAndVersion(t *testing.T) {
+	srcDir := t.TempDir()
+	iconPath := filepath.Join(srcDir, "icon.png")
+	if err := os.WriteFile(iconPath, encodeTestPNG(t, 64, color.RGBA{G: 255, A: 255}), 0644); err != nil {
+		t.Fatalf("Failed to write icon: %v", err)
+	}
+
+	dir := t.TempDir()
+	cache, err := NewIconCache(dir, time.Hour)
+	if err != nil {
+		t.Fatalf("NewIconCache failed: %v", err)
+	}
+	key := "file://" + iconPath
+	if _, err := cache.load(key, "", DefaultIconLimits); err != nil {
+		t.Fatalf("load failed: %v", err)
+	}
+	entry, icon := cache.lookup(key)
+	if icon == nil {
+		t.Fatal("expected a cached entry")
+	}
+
+	old := time.Now().Add(-2 * iconBlobGrace)
+	orphan := cache.blobPath(hashHex([]byte("orphan")))
+	fresh := cache.blobPath(hashHex([]byte("fresh")))
+	os.WriteFile(orphan, []byte("orphan"), 0644)
+	os.WriteFile(fresh, []byte("fresh"), 0644)
+	for _, path := range []string{orphan, cache.blobPath(entry.Icon64), cache.blobPath(entry.Icon256)} {
+		os.Chtimes(path, old, old)
+	}
+
+	// Referenced and young blobs survive a reopen; the old orphan does not
+	cache, _ = NewIconCache(dir, time.Hour)
+	if _, err := os.Stat(orphan); !os.IsNotExist(err) {
+		t.Error("expected the old unreferenced blob to be pruned")
+	}
+	if _, err := os.Stat(fresh); err != nil {
+		t.Error("expected a young unreferenced blob to be kept")
+	}
+	if _, icon := cache.lookup(key); icon == nil {
+		t.Fatal("expected the referenced blobs to be kept")
+	}
+
+	// An entry from another version is a miss and is pruned with its blobs
+	entry.Version = iconCacheVersion + 1
+	data, _ := json.Marshal(entry)
+	os.WriteFile(cache.entryPath(key), data, 0644)
+	if _, icon := cache.lookup(key); icon != nil {
+		t.Error("expected an entry from another version to be ignored")
+	}
+	NewIconCache(dir, time.Hour)
+	if _, err := os.Stat(cache.entryPath(key)); !os.IsNotExist(err) {
+		t.Error("expected the outdated entry to be pruned")
+	}
+	if _, err := os.Stat(cache.blobPath(entry.Icon256)); !os.IsNotExist(err) {
+		t.Error("expected the outdated entry's blobs to be pruned")
+	}
+}
@@ -1,16 +1,19 @@
 package fpkgen
 
 import (
+	"bufio"
 	"bytes"
 	"embed"
 	"fmt"
 	"image"
 	"image/png"
 	"io"
+	"log/slog"
 	"net/http"
 	"os"
 	"path/filepath"
 	"strings"
+	"sync"
 	"time"
 
 	xdraw "golang.org/x/image/draw"
@@ -25,33 +28,38 @@ import (
 //go:embed defaults/ICON.PNG defaults/ICON_256.PNG
 var defaultIcons embed.FS
 
-// handleIcons downloads/generates and saves all required icon files for all entries
-func (g *Generator) handleIcons(appDir string, config *AppConfig) error {
-	var defaultIcon image.Image
+// DefaultIconConcurrency is the default number of entry icons fetched and resized in parallel
+const DefaultIconConcurrency = 4
 
+// preparedIcon holds the PNG-encoded 64x64 and 256x256 renditions of an icon
+type preparedIcon struct {
+	png64  []byte
+	png256 []byte
+}
+
+// handleIcons downloads/generates all required icon files for all entries into the package tree
+func (g *Generator) handleIcons(tree *packageTree, config *AppConfig) error {
 	// Get base path from container labels for resolving relative file:// paths
-	basePath := getBasePath(config.Labels)
+	icons := newIconSet(g, getBasePath(config.Labels))
 
-	// Process each entry's icon
+	// Fetch and resize all distinct entry icons in parallel
+	sources := make([]string, 0, len(config.Entries))
 	for _, entry := range config.Entries {
-		entryIcon, err := loadIconFromSource(entry.Icon, basePath)
-		if err != nil {
-			fmt.Printf("Warning: Failed to load icon for entry '%s': %v\n", entry.Name, err)
-		}
+		sources = append(sources, entry.Icon)
+	}
+	if err := icons.prefetch(sources, g.iconConcurrency); err != nil {
+		return err
+	}
 
-		// Use default icon if loading failed
-		if entryIcon == nil {
-			if defaultIcon == nil {
-				defaultIcon, err = loadDefaultIcon()
-				if err != nil {
-					return fmt.Errorf("failed to load default icon: %w", err)
-				}
-			}
-			entryIcon = defaultIcon
-		}
+	// Root icons come from the default entry, or the first entry if there is none
+	var rootIcon *preparedIcon
 
-		// Pad to square and resize to required sizes
-		icon64, icon256 := prepareIcons(entryIcon)
+	// Process each entry's icon
+	for i, entry := range config.Entries {
+		icon, err := icons.get(entry.Icon)
+		if err != nil {
+			return err
+		}
 
 		// Generate icon filenames based on entry name
 		// Default entry: icon_64.png, icon_256.png
@@ -66,54 +74,148 @@ func (g *Generator) handleIcons(appDir string, config *AppConfig) error {
 		}
 
 		// Save to ui/images directory
-		uiImagesDir := filepath.Join(appDir, "app", "ui", "images")
-		if err := saveImage(icon64, filepath.Join(uiImagesDir, icon64Name)); err != nil {
-			return fmt.Errorf("failed to save icon %s: %w", icon64Name, err)
-		}
-		if err := saveImage(icon256, filepath.Join(uiImagesDir, icon256Name)); err != nil {
-			return fmt.Errorf("failed to save icon %s: %w", icon256Name, err)
+		tree.add("app/ui/images/"+icon64Name, icon.png64, 0644)
+		tree.add("app/ui/images/"+icon256Name, icon.png256, 0644)
+
+		if entry.Name == "" || i == 0 {
+			rootIcon = icon
 		}
+	}
 
-		// For default entry, also save to root directory as ICON.PNG and ICON_256.PNG
-		if entry.Name == "" {
-			if err := saveImage(icon64, filepath.Join(appDir, "ICON.PNG")); err != nil {
-				return fmt.Errorf("failed to save ICON.PNG: %w", err)
-			}
-			if err := saveImage(icon256, filepath.Join(appDir, "ICON_256.PNG")); err != nil {
-				return fmt.Errorf("failed to save ICON_256.PNG: %w", err)
-			}
+	// Save root directory icons as ICON.PNG and ICON_256.PNG
+	if rootIcon != nil {
+		tree.add("ICON.PNG", rootIcon.png64, 0644)
+		tree.add("ICON_256.PNG", rootIcon.png256, 0644)
+	}
+
+	return nil
+}
+
+// iconSet resolves entry icons for a single package generation.
+// Each distinct source is fetched, decoded and resized at most once,
+// so entries sharing an icon URL share the prepared renditions.
+type iconSet struct {
+	g        *Generator
+	basePath string
+	icons    map[string]*preparedIcon // map[iconSource]prepared icon (default icon on failure)
+}
+
+// newIconSet creates an icon set that resolves relative file:// paths against basePath
+func newIconSet(g *Generator, basePath string) *iconSet {
+	return &iconSet{
+		g:        g,
+		basePath: basePath,
+		icons:    make(map[string]*preparedIcon),
+	}
+}
+
+// prefetch loads every distinct source not yet in the set using at most
+// workers concurrent fetch/resize jobs
+func (s *iconSet) prefetch(sources []string, workers int) error {
+	var pending []string
+	seen := make(map[string]bool)
+	for _, src := range sources {
+		if _, ok := s.icons[src]; ok || seen[src] {
+			continue
 		}
+		seen[src] = true
+		pending = append(pending, src)
+	}
+	if len(pending) == 0 {
+		return nil
 	}
 
-	// If no entries had a default entry, use first entry's icon for root icons
-	if len(config.Entries) > 0 {
-		hasDefaultEntry := false
-		for _, entry := range config.Entries {
-			if entry.Name == "" {
-				hasDefaultEntry = true
-				break
+	if workers < 1 {
+		workers = 1
+	}
+	if workers > len(pending) {
+		workers = len(pending)
+	}
+
+	icons := make([]*preparedIcon, len(pending))
+	errs := make([]error, len(pending))
+	jobs := make(chan int)
+
+	var wg sync.WaitGroup
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := range jobs {
+				icons[i], errs[i] = s.load(pending[i])
 			}
+		}()
+	}
+	for i := range pending {
+		jobs <- i
+	}
+	close(jobs)
+	wg.Wait()
+
+	for i, src := range pending {
+		if errs[i] != nil {
+			return errs[i]
 		}
+		s.icons[src] = icons[i]
+	}
+	return nil
+}
 
-		if !hasDefaultEntry {
-			// Use first entry's icon for root icons
-			firstEntry := config.Entries[0]
-			entryIcon, _ := loadIconFromSource(firstEntry.Icon, basePath)
-			if entryIcon == nil {
-				if defaultIcon == nil {
-					defaultIcon, _ = loadDefaultIcon()
-				}
-				entryIcon = defaultIcon
-			}
-			if entryIcon != nil {
-				icon64, icon256 := prepareIcons(entryIcon)
-				saveImage(icon64, filepath.Join(appDir, "ICON.PNG"))
-				saveImage(icon256, filepath.Join(appDir, "ICON_256.PNG"))
-			}
+// get returns the prepared icon for a source, falling back to the default icon
+// Only a failure to load the embedded default icon is returned as an error
+func (s *iconSet) get(iconSource string) (*preparedIcon, error) {
+	if icon, ok := s.icons[iconSource]; ok {
+		return icon, nil
+	}
+
+	icon, err := s.load(iconSource)
+	if err != nil {
+		return nil, err
+	}
+	s.icons[iconSource] = icon
+	return icon, nil
+}
+
+// load prepares a single source without touching the set
+func (s *iconSet) load(iconSource string) (*preparedIcon, error) {
+	icon, err := s.g.loadPreparedIcon(iconSource, s.basePath)
+	if err != nil {
+		slog.Warn("Failed to load icon, using default", "source", iconSource, "error", err)
+		icon, err = loadDefaultPreparedIcon()
+		if err != nil {
+			return nil, fmt.Errorf("failed to load default icon: %w", err)
 		}
 	}
+	return icon, nil
+}
 
-	return nil
+// loadPreparedIcon loads an icon and returns its encoded 64/256 renditions,
+// going through the persistent icon cache when one is configured
+func (g *Generator) loadPreparedIcon(iconSource string, basePath string) (*preparedIcon, error) {
+	if g.iconCache != nil {
+		return g.iconCache.load(iconSource, basePath, g.iconLimits)
+	}
+
+	img, err := loadIconFromSource(iconSource, basePath, g.iconLimits)
+	if err != nil {
+		return nil, err
+	}
+	return encodePreparedIcon(img)
+}
+
+// encodePreparedIcon pads, resizes and PNG-encodes an icon
+func encodePreparedIcon(src image.Image) (*preparedIcon, error) {
+	icon64, icon256 := prepareIcons(src)
+
+	var buf64, buf256 bytes.Buffer
+	if err := png.Encode(&buf64, icon64); err != nil {
+		return nil, fmt.Errorf("failed to encode 64px icon: %w", err)
+	}
+	if err := png.Encode(&buf256, icon256); err != nil {
+		return nil, fmt.Errorf("failed to encode 256px icon: %w", err)
+	}
+
+	return &preparedIcon{png64: buf64.Bytes(), png256: buf256.Bytes()}, nil
 }
 
 // getBasePath extracts the compose working directory from container labels
@@ -150,7 +252,7 @@ func resolveFilePath(fileURL string, basePath string) (string, error) {
 
 // loadIconFromSource loads an icon from URL or local file path
 // basePath: the base directory for resolving relative file:// paths (compose working directory)
-func loadIconFromSource(iconSource string, basePath string) (image.Image, error) {
+func loadIconFromSource(iconSource string, basePath string, limits IconLimits) (image.Image, error) {
 	if iconSource == "" {
 		return nil, fmt.Errorf("empty icon source")
 	}
@@ -161,15 +263,35 @@ func loadIconFromSource(iconSource string, basePath string) (image.Image, error)
 		if err != nil {
 			return nil, fmt.Errorf("failed to resolve file path: %w", err)
 		}
-		return loadLocalIcon(localPath)
+		return loadLocalIcon(localPath, limits)
 	} else if strings.HasPrefix(iconSource, "http") {
 		// Download from URL
-		return downloadIcon(iconSource)
+		return downloadIcon(iconSource, limits)
 	}
 
 	return nil, fmt.Errorf("unsupported icon source: %s", iconSource)
 }
 
+// Embedded default icon, prepared once per process
+var (
+	defaultPreparedOnce sync.Once
+	defaultPrepared     *preparedIcon
+	defaultPreparedErr  error
+)
+
+// loadDefaultPreparedIcon returns the encoded renditions of the embedded default icon
+func loadDefaultPreparedIcon() (*preparedIcon, error) {
+	defaultPreparedOnce.Do(func() {
+		img, err := loadDefaultIcon()
+		if err != nil {
+			defaultPreparedErr = err
+			return
+		}
+		defaultPrepared, defaultPreparedErr = encodePreparedIcon(img)
+	})
+	return defaultPrepared, defaultPreparedErr
+}
+
 // loadDefaultIcon loads the embedded default icon
 func loadDefaultIcon() (image.Image, error) {
 	data, err := defaultIcons.ReadFile("defaults/ICON_256.PNG")
@@ -187,67 +309,136 @@ func loadDefaultIcon() (image.Image, error) {
 
 // loadLocalIcon loads an icon from local file path
 // Supports multiple formats: PNG, JPEG, WebP, BMP, ICO
-func loadLocalIcon(path string) (image.Image, error) {
-	data, err := os.ReadFile(path)
+func loadLocalIcon(path string, limits IconLimits) (image.Image, error) {
+	f, err := os.Open(path)
 	if err != nil {
 		return nil, fmt.Errorf("file not found: %s", path)
 	}
+	defer f.Close()
 
-	// Detect format using magic bytes
-	format := detectFormat(data)
-
-	// For ICO format, use custom decoder
-	if format == FormatICO {
-		img, err := decodeICO(data)
-		if err != nil {
-			return nil, fmt.Errorf("failed to decode ICO image: %w", err)
-		}
-		return img, nil
+	if info, err := f.Stat(); err == nil && limits.MaxBytes > 0 && info.Size() > limits.MaxBytes {
+		return nil, fmt.Errorf("icon file is %d bytes, exceeds limit of %d bytes", info.Size(), limits.MaxBytes)
 	}
 
-	// For other formats (PNG, JPEG, WebP, BMP), use standard image.Decode
-	// The decoders are registered via imports at the top of this file
-	if format == FormatUnknown {
-		return nil, fmt.Errorf("unsupported image format: detected %s", format)
-	}
+	return decodeIconStream(f, limits)
+}
 
-	img, _, err := image.Decode(bytes.NewReader(data))
-	if err != nil {
-		return nil, fmt.Errorf("failed to decode %s image: %w", format, err)
-	}
+// iconHTTPClient is shared by all icon downloads so that connections to
+// icon CDNs are kept alive across entries and packages
+var iconHTTPClient = &http.Client{
+	Timeout: 60 * time.Second,
+	Transport: &http.Transport{
+		Proxy:               http.ProxyFromEnvironment,
+		ForceAttemptHTTP2:   true,
+		MaxIdleConns:        32,
+		MaxIdleConnsPerHost: 8,
+		IdleConnTimeout:     90 * time.Second,
+		TLSHandshakeTimeout: 10 * time.Second,
+	},
+}
 
-	return img, nil
+// iconValidators carries HTTP cache validators from a previous icon download
+type iconValidators struct {
+	ETag         string
+	LastModified string
 }
 
 // downloadIcon downloads an icon from URL
 // Supports multiple formats: PNG, JPEG, WebP, BMP, ICO
-func downloadIcon(url string) (image.Image, error) {
-	client := &http.Client{
-		Timeout: 60 * time.Second,
+func downloadIcon(url string, limits IconLimits) (image.Image, error) {
+	img, _, _, err := downloadIconConditional(url, iconValidators{}, limits)
+	return img, err
+}
+
+// downloadIconConditional downloads an icon from URL, sending the validators
+// of a previous download. notModified is true when the server answered 304,
+// in which case img is nil and the caller should reuse its cached copy.
+func downloadIconConditional(url string, prev iconValidators, limits IconLimits) (img image.Image, next iconValidators, notModified bool, err error) {
+	req, err := http.NewRequest(http.MethodGet, url, nil)
+	if err != nil {
+		return nil, next, false, err
+	}
+	if prev.ETag != "" {
+		req.Header.Set("If-None-Match", prev.ETag)
+	}
+	if prev.LastModified != "" {
+		req.Header.Set("If-Modified-Since", prev.LastModified)
 	}
 
-	resp, err := client.Get(url)
+	resp, err := iconHTTPClient.Do(req)
 	if err != nil {
-		return nil, err
+		return nil, next, false, err
 	}
 	defer resp.Body.Close()
 
+	if resp.StatusCode == http.StatusNotModified {
+		return nil, prev, true, nil
+	}
 	if resp.StatusCode != http.StatusOK {
-		return nil, fmt.Errorf("failed to download icon: status %d", resp.StatusCode)
+		// Drain a little of the body so the connection can be reused
+		io.Copy(io.Discard, io.LimitReader(resp.Body, 4096))
+		return nil, next, false, fmt.Errorf("failed to download icon: status %d", resp.StatusCode)
+	}
+
+	next = iconValidators{
+		ETag:         resp.Header.Get("ETag"),
+		LastModified: resp.Header.Get("Last-Modified"),
+	}
+
+	// Reject oversized bodies before reading anything when the size is announced
+	if limits.MaxBytes > 0 && resp.ContentLength > limits.MaxBytes {
+		return nil, next, false, fmt.Errorf("icon is %d bytes, exceeds limit of %d bytes", resp.ContentLength, limits.MaxBytes)
 	}
 
-	// Read the body
-	body, err := io.ReadAll(resp.Body)
+	img, err = decodeIconStream(resp.Body, limits)
 	if err != nil {
+		return nil, next, false, err
+	}
+	return img, next, false, nil
+}
+
+// IconLimits bounds the resources a single icon may consume while decoding
+type IconLimits struct {
+	MaxBytes  int64 // Maximum encoded size in bytes (0 = unlimited)
+	MaxPixels int   // Maximum decoded width*height (0 = unlimited)
+}
+
+// DefaultIconLimits is generous for icons while keeping a bad label from
+// pulling a multi-megabyte image or HTML page into memory
+var DefaultIconLimits = IconLimits{
+	MaxBytes:  4 << 20,
+	MaxPixels: 4096 * 4096,
+}
+
+// decodeIconStream sniffs the format from the first bytes of r and decodes
+// the image without buffering the whole body (except for ICO, which needs
+// random access to its directory). The pixel budget is checked with
+// image.DecodeConfig before any pixel data is decoded.
+func decodeIconStream(r io.Reader, limits IconLimits) (image.Image, error) {
+	if limits.MaxBytes > 0 {
+		r = &cappedReader{r: io.LimitReader(r, limits.MaxBytes+1), max: limits.MaxBytes}
+	}
+	br := bufio.NewReaderSize(r, 512)
+
+	// Detect format using magic bytes (12 bytes covers the WebP RIFF header)
+	head, err := br.Peek(12)
+	if err != nil && err != io.EOF && err != bufio.ErrBufferFull {
 		return nil, err
 	}
+	format := detectFormat(head)
 
-	// Detect format using magic bytes
-	format := detectFormat(body)
+	// Reject HTML error pages and other non-images before reading the body
+	if format == FormatUnknown {
+		return nil, fmt.Errorf("unsupported image format: detected %s", format)
+	}
 
 	// For ICO format, use custom decoder
 	if format == FormatICO {
-		img, err := decodeICO(body)
+		data, err := io.ReadAll(br)
+		if err != nil {
+			return nil, err
+		}
+		img, err := decodeICO(data, limits)
 		if err != nil {
 			return nil, fmt.Errorf("failed to decode ICO image: %w", err)
 		}
@@ -255,30 +446,127 @@ func downloadIcon(url string) (image.Image, error) {
 	}
 
 	// For other formats (PNG, JPEG, WebP, BMP), use standard image.Decode
-	if format == FormatUnknown {
-		return nil, fmt.Errorf("unsupported image format: detected %s", format)
+	// The decoders are registered via imports at the top of this file.
+	// Read the header through a tee so the full decode can replay it.
+	var header bytes.Buffer
+	cfg, _, err := image.DecodeConfig(io.TeeReader(br, &header))
+	if err != nil {
+		return nil, fmt.Errorf("failed to decode %s image: %w", format, err)
+	}
+	if err := limits.checkPixels(cfg.Width, cfg.Height); err != nil {
+		return nil, err
 	}
 
-	img, _, err := image.Decode(bytes.NewReader(body))
+	img, _, err := image.Decode(io.MultiReader(&header, br))
 	if err != nil {
 		return nil, fmt.Errorf("failed to decode %s image: %w", format, err)
 	}
-
 	return img, nil
 }
 
+// checkPixels returns an error if width*height exceeds the pixel budget
+func (l IconLimits) checkPixels(width, height int) error {
+	if l.MaxPixels > 0 && width*height > l.MaxPixels {
+		return fmt.Errorf("icon is %dx%d pixels, exceeds limit of %d pixels", width, height, l.MaxPixels)
+	}
+	return nil
+}
+
+// cappedReader fails once more than max bytes have been read from r
+type cappedReader struct {
+	r    io.Reader
+	max  int64
+	read int64
+}
+
+func (c *cappedReader) Read(p []byte) (int, error) {
+	n, err := c.r.Read(p)
+	c.read += int64(n)
+	if c.read > c.max {
+		return n, fmt.Errorf("icon exceeds limit of %d bytes", c.max)
+	}
+	return n, err
+}
+
 // prepareIcons pads a non-square image to square and resizes to 64x64 and 256x256
+// When the source is at least 256px, the 64px rendition is derived from the
+// 256px one (an exact 4x box downscale) instead of the full-resolution source.
 func prepareIcons(src image.Image) (icon64, icon256 image.Image) {
 	squared := squareImage(src)
-	icon64 = resizeImage(squared, 64, 64)
 	icon256 = resizeImage(squared, 256, 256)
+	if squared.Bounds().Dx() >= 256 {
+		icon64 = resizeImage(icon256, 64, 64)
+	} else {
+		icon64 = resizeImage(squared, 64, 64)
+	}
 	return
 }
 
 // resizeImage resizes an image to the specified dimensions
+// Fast paths:
+//   - source already at the target size is returned as-is
+//   - exact integer downscales use a box filter
+//   - everything else is resampled with CatmullRom
 func resizeImage(src image.Image, width, height int) image.Image {
+	bounds := src.Bounds()
+	if bounds.Dx() == width && bounds.Dy() == height {
+		return src
+	}
+
+	if bounds.Dx()%width == 0 && bounds.Dy()%height == 0 {
+		factor := bounds.Dx() / width
+		if factor > 1 && bounds.Dy()/height == factor {
+			return boxDownscale(toRGBA(src), factor)
+		}
+	}
+
 	dst := image.NewRGBA(image.Rect(0, 0, width, height))
-	xdraw.CatmullRom.Scale(dst, dst.Bounds(), src, src.Bounds(), xdraw.Over, nil)
+	xdraw.CatmullRom.Scale(dst, dst.Bounds(), src, bounds, xdraw.Over, nil)
+	return dst
+}
+
+// boxDownscale shrinks src by an integer factor, averaging each factor x factor block.
+// Averaging premultiplied RGBA values is exact for alpha compositing.
+func boxDownscale(src *image.RGBA, factor int) *image.RGBA {
+	bounds := src.Bounds()
+	width, height := bounds.Dx()/factor, bounds.Dy()/factor
+	dst := image.NewRGBA(image.Rect(0, 0, width, height))
+
+	area := uint32(factor * factor)
+	sums := make([]uint32, width*4)
+	for y := 0; y < height; y++ {
+		clear(sums)
+		for sy := y * factor; sy < (y+1)*factor; sy++ {
+			row := src.Pix[src.PixOffset(bounds.Min.X, bounds.Min.Y+sy):]
+			for x := 0; x < width; x++ {
+				sum := sums[x*4 : x*4+4]
+				block := row[x*factor*4 : (x+1)*factor*4]
+				for i := 0; i < len(block); i += 4 {
+					sum[0] += uint32(block[i])
+					sum[1] += uint32(block[i+1])
+					sum[2] += uint32(block[i+2])
+					sum[3] += uint32(block[i+3])
+				}
+			}
+		}
+
+		out := dst.Pix[y*dst.Stride : y*dst.Stride+width*4]
+		for i, v := range sums {
+			out[i] = uint8((v + area/2) / area)
+		}
+	}
+
+	return dst
+}
+
+// toRGBA returns src as *image.RGBA, converting only if necessary
+func toRGBA(src image.Image) *image.RGBA {
+	if rgba, ok := src.(*image.RGBA); ok {
+		return rgba
+	}
+	bounds := src.Bounds()
+	dst := image.NewRGBA(bounds)
+	xdraw.Draw(dst, bounds, src, bounds.Min, xdraw.Src)
 	return dst
 }
 
@@ -313,14 +601,3 @@ func squareImage(src image.Image) image.Image {
 
 	return dst
 }
-
-// saveImage saves an image to a file
-func saveImage(img image.Image, path string) error {
-	f, err := os.Create(path)
-	if err != nil {
-		return err
-	}
-	defer f.Close()
-
-	return png.Encode(f, img)
-}
@@ -0,0 +1,97 @@
+package fpkgen
+
+import (
+	"fmt"
+	"image"
+	"image/color"
+	"net/http"
+	"net/http/httptest"
+	"os"
+	"path/filepath"
+	"testing"
+)
+
+// BenchmarkDecodeICO measures decoding the ICO files in testdata
+func BenchmarkDecodeICO(b *testing.B) {
+	for _, name := range []string{"test.ico", "test_multi.ico"} {
+		data, err := os.ReadFile(filepath.Join("testdata", name))
+		if err != nil {
+			b.Skipf("testdata/%s not found, run 'go run testdata/generate_testdata.go' to create", name)
+		}
+		b.Run(name, func(b *testing.B) {
+			b.SetBytes(int64(len(data)))
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				if _, err := decodeICO(data, IconLimits{}); err != nil {
+					b.Fatalf("decodeICO failed: %v", err)
+				}
+			}
+		})
+	}
+}
+
+// BenchmarkPrepareIcons measures squaring and resizing across source sizes,
+// covering the upscale, box-downscale and resample paths
+func BenchmarkPrepareIcons(b *testing.B) {
+	sizes := []struct{ w, h int }{
+		{32, 32}, {200, 200}, {256, 256}, {300, 200}, {512, 512}, {1024, 1024},
+	}
+	for _, size := range sizes {
+		src := image.NewRGBA(image.Rect(0, 0, size.w, size.h))
+		for y := 0; y < size.h; y++ {
+			for x := 0; x < size.w; x++ {
+				src.Set(x, y, color.RGBA{R: uint8(x), G: uint8(y), B: 128, A: 255})
+			}
+		}
+		b.Run(fmt.Sprintf("%dx%d", size.w, size.h), func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				prepareIcons(src)
+			}
+		})
+	}
+}
+
+// BenchmarkGenerateFromConfig_HTTPIcon measures a full package whose entries
+// share one icon served over HTTP, with and without the persistent cache
+func BenchmarkGenerateFromConfig_HTTPIcon(b *testing.B) {
+	silenceLogs(b)
+	data := encodeTestPNG(b, 512, color.RGBA{B: 255, A: 255})
+	srv := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		w.Header().Set("Content-Type", "image/png")
+		w.Write(data)
+	}))
+	defer srv.Close()
+
+	engine, err := NewTemplateEngine()
+	if err != nil {
+		b.Fatalf("NewTemplateEngine failed: %v", err)
+	}
+
+	for _, cached := range []bool{false, true} {
+		name := "nocache"
+		if cached {
+			name = "cache"
+		}
+		b.Run(name, func(b *testing.B) {
+			dir := b.TempDir()
+			g := &Generator{templateEngine: engine, iconConcurrency: DefaultIconConcurrency, iconLimits: DefaultIconLimits}
+			if cached {
+				cache, err := NewIconCache(filepath.Join(dir, "cache"), DefaultIconCacheTTL)
+				if err != nil {
+					b.Fatalf("NewIconCache failed: %v", err)
+				}
+				g.iconCache = cache
+			}
+
+			appDir := filepath.Join(dir, "pkg")
+			b.ReportAllocs()
+			b.ResetTimer()
+			for i := 0; i < b.N; i++ {
+				if err := g.GenerateFromConfig(benchConfig(srv.URL+"/icon.png"), appDir); err != nil {
+					b.Fatalf("GenerateFromConfig failed: %v", err)
+				}
+			}
+		})
+	}
+}
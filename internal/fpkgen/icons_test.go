@@ -0,0 +1,218 @@
+package fpkgen
+
+import (
+	"bytes"
+	"image"
+	"image/color"
+	"net/http"
+	"net/http/httptest"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync/atomic"
+	"testing"
+)
+
+// writeTestIcons runs handleIcons for config and writes the resulting tree to a temp dir
+func writeTestIcons(t *testing.T, g *Generator, config *AppConfig) string {
+	t.Helper()
+	tree := newPackageTree()
+	if err := g.handleIcons(tree, config); err != nil {
+		t.Fatalf("handleIcons failed: %v", err)
+	}
+	appDir := t.TempDir()
+	if err := tree.writeTo(appDir); err != nil {
+		t.Fatalf("writeTo failed: %v", err)
+	}
+	return appDir
+}
+
+// TestHandleIcons_SharedSourceFetchedOnce tests that entries sharing an icon URL cost one download
+func TestHandleIcons_SharedSourceFetchedOnce(t *testing.T) {
+	var requests int32
+	data := encodeTestPNG(t, 96, color.RGBA{R: 200, A: 255})
+	srv := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		atomic.AddInt32(&requests, 1)
+		w.Write(data)
+	}))
+	defer srv.Close()
+
+	iconURL := srv.URL + "/shared.png"
+	config := &AppConfig{
+		AppName: "watchcow.test",
+		Entries: []Entry{
+			{Name: "admin", Icon: iconURL},
+			{Name: "user", Icon: iconURL},
+			{Name: "api", Icon: iconURL},
+		},
+	}
+
+	appDir := writeTestIcons(t, &Generator{}, config)
+
+	if requests != 1 {
+		t.Errorf("expected 1 download for shared icon, got %d", requests)
+	}
+
+	// Without a default entry, root icons come from the first entry
+	root, err := os.ReadFile(filepath.Join(appDir, "ICON_256.PNG"))
+	if err != nil {
+		t.Fatalf("ICON_256.PNG not written: %v", err)
+	}
+	first, err := os.ReadFile(filepath.Join(appDir, "app", "ui", "images", "icon_admin_256.png"))
+	if err != nil {
+		t.Fatalf("icon_admin_256.png not written: %v", err)
+	}
+	if !bytes.Equal(root, first) {
+		t.Error("expected ICON_256.PNG to match first entry icon")
+	}
+}
+
+// TestHandleIcons_FallbackToDefault tests that an unloadable icon falls back to the embedded default
+func TestHandleIcons_FallbackToDefault(t *testing.T) {
+	config := &AppConfig{
+		AppName: "watchcow.test",
+		Entries: []Entry{{Name: "", Icon: "ftp://example.com/icon.png"}},
+	}
+
+	appDir := writeTestIcons(t, &Generator{}, config)
+
+	for _, name := range []string{"ICON.PNG", "ICON_256.PNG", "app/ui/images/icon_64.png", "app/ui/images/icon_256.png"} {
+		if _, err := os.Stat(filepath.Join(appDir, name)); err != nil {
+			t.Errorf("expected %s to be written: %v", name, err)
+		}
+	}
+}
+
+// TestHandleIcons_ParallelFetch tests that distinct entry icons are fetched concurrently
+func TestHandleIcons_ParallelFetch(t *testing.T) {
+	var inFlight, maxInFlight int32
+	release := make(chan struct{})
+	data := encodeTestPNG(t, 64, color.RGBA{G: 200, A: 255})
+	srv := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		n := atomic.AddInt32(&inFlight, 1)
+		for {
+			m := atomic.LoadInt32(&maxInFlight)
+			if n <= m || atomic.CompareAndSwapInt32(&maxInFlight, m, n) {
+				break
+			}
+		}
+		if n == 3 {
+			close(release)
+		}
+		<-release
+		atomic.AddInt32(&inFlight, -1)
+		w.Write(data)
+	}))
+	defer srv.Close()
+
+	config := &AppConfig{
+		AppName: "watchcow.test",
+		Entries: []Entry{
+			{Name: "", Icon: srv.URL + "/a.png"},
+			{Name: "b", Icon: srv.URL + "/b.png"},
+			{Name: "c", Icon: srv.URL + "/c.png"},
+		},
+	}
+
+	appDir := writeTestIcons(t, &Generator{iconConcurrency: 3}, config)
+
+	if maxInFlight != 3 {
+		t.Errorf("expected 3 concurrent downloads, got %d", maxInFlight)
+	}
+	for _, name := range []string{"icon_64.png", "icon_b_64.png", "icon_c_256.png"} {
+		if _, err := os.Stat(filepath.Join(appDir, "app", "ui", "images", name)); err != nil {
+			t.Errorf("expected %s to be written: %v", name, err)
+		}
+	}
+}
+
+// TestResizeImage_IdentityReturnsSource tests that an image already at the target size is not copied
+func TestResizeImage_IdentityReturnsSource(t *testing.T) {
+	src := image.NewRGBA(image.Rect(0, 0, 256, 256))
+	if got := resizeImage(src, 256, 256); got != image.Image(src) {
+		t.Error("expected resizeImage to return the source for identity size")
+	}
+}
+
+// TestResizeImage_BoxDownscale tests exact integer downscales average each block
+func TestResizeImage_BoxDownscale(t *testing.T) {
+	// Pixel checkerboard: every 2x2 block holds two white and two black pixels
+	src := image.NewRGBA(image.Rect(0, 0, 512, 512))
+	for y := 0; y < 512; y++ {
+		for x := 0; x < 512; x++ {
+			if (x+y)%2 == 0 {
+				src.SetRGBA(x, y, color.RGBA{R: 255, G: 255, B: 255, A: 255})
+			} else {
+				src.SetRGBA(x, y, color.RGBA{A: 255})
+			}
+		}
+	}
+
+	dst := resizeImage(src, 256, 256)
+	if dst.Bounds().Dx() != 256 || dst.Bounds().Dy() != 256 {
+		t.Fatalf("expected 256x256, got %v", dst.Bounds())
+	}
+	r, g, b, a := dst.At(10, 10).RGBA()
+	if r>>8 != 128 || g>>8 != 128 || b>>8 != 128 || a>>8 != 255 {
+		t.Errorf("expected mid gray, got (%d, %d, %d, %d)", r>>8, g>>8, b>>8, a>>8)
+	}
+}
+
+// TestPrepareIcons_Sizes tests output sizes for several source sizes
+func TestPrepareIcons_Sizes(t *testing.T) {
+	for _, size := range []int{16, 64, 100, 256, 300, 1024} {
+		icon64, icon256 := prepareIcons(image.NewNRGBA(image.Rect(0, 0, size, size/2+1)))
+		if icon64.Bounds().Dx() != 64 || icon64.Bounds().Dy() != 64 {
+			t.Errorf("size %d: expected 64x64, got %v", size, icon64.Bounds())
+		}
+		if icon256.Bounds().Dx() != 256 || icon256.Bounds().Dy() != 256 {
+			t.Errorf("size %d: expected 256x256, got %v", size, icon256.Bounds())
+		}
+	}
+}
+
+// TestDownloadIcon_Limits tests that oversized, non-image and huge-dimension downloads are rejected
+func TestDownloadIcon_Limits(t *testing.T) {
+	pngData := encodeTestPNG(t, 128, color.RGBA{B: 200, A: 255})
+	srv := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		switch r.URL.Path {
+		case "/html":
+			w.Header().Set("Content-Type", "text/html")
+			w.Write([]byte("<!DOCTYPE html><html><body>Not Found</body></html>"))
+		case "/chunked":
+			// No Content-Length: the cap must be enforced while streaming
+			w.(http.Flusher).Flush()
+			w.Write(pngData)
+		default:
+			w.Write(pngData)
+		}
+	}))
+	defer srv.Close()
+
+	cases := []struct {
+		name   string
+		path   string
+		limits IconLimits
+		errMsg string
+	}{
+		{"html page", "/html", DefaultIconLimits, "unsupported image format"},
+		{"content length over cap", "/icon.png", IconLimits{MaxBytes: 64}, "exceeds limit"},
+		{"streamed body over cap", "/chunked", IconLimits{MaxBytes: 64}, "exceeds limit"},
+		{"too many pixels", "/icon.png", IconLimits{MaxPixels: 64 * 64}, "exceeds limit"},
+	}
+
+	for _, tc := range cases {
+		_, err := downloadIcon(srv.URL+tc.path, tc.limits)
+		if err == nil || !strings.Contains(err.Error(), tc.errMsg) {
+			t.Errorf("%s: expected error containing %q, got %v", tc.name, tc.errMsg, err)
+		}
+	}
+
+	img, err := downloadIcon(srv.URL+"/icon.png", DefaultIconLimits)
+	if err != nil {
+		t.Fatalf("expected download within limits to succeed: %v", err)
+	}
+	if img.Bounds().Dx() != 128 {
+		t.Errorf("expected 128px image, got %v", img.Bounds())
+	}
+}
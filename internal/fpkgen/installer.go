@@ -1,28 +1,82 @@
 package fpkgen
 
 import (
+	"context"
 	"fmt"
 	"log/slog"
 	"os"
 	"os/exec"
+	"path/filepath"
 	"strings"
+	"sync"
+	"time"
 )
 
-// Installer handles fnOS application installation via appcenter-cli
-type Installer struct {
+// appsRoot is where fnOS installs apps (<appsRoot>/<appname>/target holds app/)
+const appsRoot = "/var/apps"
+
+// Installer installs and controls fnOS apps in the App Center.
+// CLIInstaller drives appcenter-cli.
+type Installer interface {
+	InstallLocal(ctx context.Context, appDir string) error
+	Uninstall(ctx context.Context, appName string) error
+	StartApp(ctx context.Context, appName string) error
+	StopApp(ctx context.Context, appName string) error
+
+	// SupportsBatch reports whether the *Apps methods for op ("start",
+	// "stop", "uninstall") cost one call rather than one per app
+	SupportsBatch(op string) bool
+	StartApps(ctx context.Context, appNames []string) []error
+	StopApps(ctx context.Context, appNames []string) []error
+	UninstallApps(ctx context.Context, appNames []string) []error
+
+	// ListInstalledApps returns the names of all installed apps
+	ListInstalledApps(ctx context.Context) ([]string, error)
+
+	// InstalledPackageHash returns the package hash recorded in an installed
+	// app, or "" if the app is not installed or was installed without one
+	InstalledPackageHash(appName string) string
+}
+
+// installerConfig collects InstallerOption settings
+type installerConfig struct {
+	timeouts CLITimeouts
+}
+
+// NewInstaller returns the appcenter-cli installer
+func NewInstaller(opts ...InstallerOption) (Installer, error) {
+	cli, err := NewCLIInstaller(opts...)
+	if err != nil {
+		return nil, err
+	}
+	return cli, nil
+}
+
+// CLIInstaller handles fnOS application installation via appcenter-cli
+type CLIInstaller struct {
 	appcenterCLIPath string
+	timeouts         CLITimeouts   // Per-subcommand deadlines (zero = DefaultCLITimeouts)
+	retryDelay       time.Duration // First retry delay for idempotent subcommands (0 = default)
+
+	batchMu  sync.Mutex
+	batchOps map[string]bool // Detected multi-app support per subcommand
 }
 
-// NewInstaller creates a new installer
-func NewInstaller() (*Installer, error) {
+// NewCLIInstaller creates an installer that runs appcenter-cli
+func NewCLIInstaller(opts ...InstallerOption) (*CLIInstaller, error) {
 	// Find appcenter-cli
 	cliPath, err := findAppcenterCLI()
 	if err != nil {
 		return nil, err
 	}
 
-	return &Installer{
+	var cfg installerConfig
+	for _, opt := range opts {
+		opt(&cfg)
+	}
+	return &CLIInstaller{
 		appcenterCLIPath: cliPath,
+		timeouts:         cfg.timeouts,
 	}, nil
 }
 
@@ -64,59 +118,41 @@ func findAppcenterCLI() (string, error) {
 }
 
 // InstallLocal installs an application from local directory
-func (i *Installer) InstallLocal(appDir string) error {
-	slog.Info("Installing fnOS app via appcenter-cli", "appDir", appDir)
-
-	cmd := exec.Command(i.appcenterCLIPath, "install-local")
-	cmd.Dir = appDir
-	cmd.Stdout = os.Stdout
-	cmd.Stderr = os.Stderr
+func (i *CLIInstaller) InstallLocal(ctx context.Context, appDir string) error {
+	defer cliDuration.Since("install-local", time.Now())
+	slog.InfoContext(ctx, "Installing fnOS app via appcenter-cli", "appDir", appDir)
 
-	if err := cmd.Run(); err != nil {
+	if err := i.runCLI(ctx, appDir, "install-local"); err != nil {
 		return fmt.Errorf("appcenter-cli install-local failed: %w", err)
 	}
 
-	slog.Info("Successfully installed fnOS app")
+	slog.InfoContext(ctx, "Successfully installed fnOS app")
 	return nil
 }
 
-// Uninstall uninstalls an application
-func (i *Installer) Uninstall(appName string) error {
-	slog.Info("Uninstalling fnOS app", "appName", appName)
+// Uninstall stops and uninstalls an application
+func (i *CLIInstaller) Uninstall(ctx context.Context, appName string) error {
+	defer cliDuration.Since("uninstall", time.Now())
+	slog.InfoContext(ctx, "Uninstalling fnOS app", "appName", appName)
 
 	// First stop the app
-	stopCmd := exec.Command(i.appcenterCLIPath, "stop", appName)
-	stopCmd.Run() // Ignore stop errors
+	i.tryCLI(ctx, "stop", appName) // Ignore stop errors
 
 	// Try to uninstall with appName as argument
-	uninstallCmd := exec.Command(i.appcenterCLIPath, "uninstall", appName)
-	output, err := uninstallCmd.CombinedOutput()
-	if err != nil {
-		// Try without argument (some versions may work differently)
-		slog.Debug("Uninstall with appName failed, trying alternate method",
-			"appName", appName,
-			"output", string(output))
-
-		// Log warning but don't fail - app may need manual uninstall
-		slog.Warn("Could not uninstall fnOS app automatically",
-			"appName", appName,
-			"hint", "may need manual uninstall from App Center")
-		return nil
+	if err := i.runCLI(ctx, "", "uninstall", appName); err != nil {
+		return fmt.Errorf("failed to uninstall app: %w", err)
 	}
 
-	slog.Info("Successfully uninstalled fnOS app", "appName", appName)
+	slog.InfoContext(ctx, "Successfully uninstalled fnOS app", "appName", appName)
 	return nil
 }
 
 // StartApp starts an installed application
-func (i *Installer) StartApp(appName string) error {
-	slog.Info("Starting fnOS app", "appName", appName)
+func (i *CLIInstaller) StartApp(ctx context.Context, appName string) error {
+	defer cliDuration.Since("start", time.Now())
+	slog.InfoContext(ctx, "Starting fnOS app", "appName", appName)
 
-	cmd := exec.Command(i.appcenterCLIPath, "start", appName)
-	cmd.Stdout = os.Stdout
-	cmd.Stderr = os.Stderr
-
-	if err := cmd.Run(); err != nil {
+	if err := i.runCLI(ctx, "", "start", appName); err != nil {
 		return fmt.Errorf("failed to start app: %w", err)
 	}
 
@@ -124,66 +160,53 @@ func (i *Installer) StartApp(appName string) error {
 }
 
 // StopApp stops an installed application
-func (i *Installer) StopApp(appName string) error {
-	slog.Info("Stopping fnOS app", "appName", appName)
-
-	cmd := exec.Command(i.appcenterCLIPath, "stop", appName)
-	cmd.Stdout = os.Stdout
-	cmd.Stderr = os.Stderr
+func (i *CLIInstaller) StopApp(ctx context.Context, appName string) error {
+	defer cliDuration.Since("stop", time.Now())
+	slog.InfoContext(ctx, "Stopping fnOS app", "appName", appName)
 
-	if err := cmd.Run(); err != nil {
+	if err := i.runCLI(ctx, "", "stop", appName); err != nil {
 		return fmt.Errorf("failed to stop app: %w", err)
 	}
 
 	return nil
 }
 
-// ListApps lists all installed applications
-func (i *Installer) ListApps() ([]string, error) {
-	cmd := exec.Command(i.appcenterCLIPath, "list")
-	output, err := cmd.Output()
+// ListInstalledApps returns the names of all installed apps by parsing appcenter-cli list output
+func (i *CLIInstaller) ListInstalledApps(ctx context.Context) ([]string, error) {
+	defer cliDuration.Since("list", time.Now())
+	output, err := i.outputCLI(ctx, "list")
 	if err != nil {
 		return nil, fmt.Errorf("failed to list apps: %w", err)
 	}
+	return parseAppList(string(output)), nil
+}
 
-	// Parse output (format depends on appcenter-cli output)
-	lines := strings.Split(string(output), "\n")
-	var apps []string
-	for _, line := range lines {
-		line = strings.TrimSpace(line)
-		if line != "" {
-			apps = append(apps, line)
-		}
-	}
-
-	return apps, nil
+// InstalledPackageHash returns the package hash recorded in an installed app,
+// or "" if the app is not installed or was installed without one
+func (i *CLIInstaller) InstalledPackageHash(appName string) string {
+	return installedPackageHash(appName)
 }
 
-// IsAppInstalled checks if an app is installed by parsing appcenter-cli list output
-func (i *Installer) IsAppInstalled(appName string) bool {
-	cmd := exec.Command(i.appcenterCLIPath, "list")
-	output, err := cmd.Output()
-	if err != nil {
-		slog.Debug("Failed to list apps", "error", err)
-		return false
-	}
+// installedPackageHash reads the hash from the app's install directory
+func installedPackageHash(appName string) string {
+	return readPackageHash(filepath.Join(appsRoot, appName, "target"))
+}
 
-	// Parse table output - look for appName in the first column
-	lines := strings.Split(string(output), "\n")
+// parseAppList extracts app names from the first column of appcenter-cli list table output
+func parseAppList(output string) []string {
+	var apps []string
+	lines := strings.Split(output, "\n")
 	for _, line := range lines {
 		// Skip header and separator lines
 		if strings.HasPrefix(line, "│") {
 			// Extract first column (app name)
 			parts := strings.Split(line, "│")
 			if len(parts) >= 2 {
-				installedApp := strings.TrimSpace(parts[1])
-				if installedApp == appName {
-					slog.Debug("App already installed", "appName", appName)
-					return true
+				if name := strings.TrimSpace(parts[1]); name != "" {
+					apps = append(apps, name)
 				}
 			}
 		}
 	}
-
-	return false
+	return apps
 }
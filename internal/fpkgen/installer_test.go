@@ -0,0 +1,30 @@
+package fpkgen
+
+import (
+	"reflect"
+	"testing"
+)
+
+// TestParseAppList tests extracting app names from appcenter-cli list table output
+func TestParseAppList(t *testing.T) {
+	output := `┌──────────────────┬─────────┬─────────┐
+│ APPNAME          │ VERSION │ STATUS  │
+├──────────────────┼─────────┼─────────┤
+│ watchcow         │ 1.0.0   │ running │
+│ watchcow.memos   │ 1.0.0   │ stopped │
+│                  │         │         │
+└──────────────────┴─────────┴─────────┘
+`
+	got := parseAppList(output)
+	want := []string{"APPNAME", "watchcow", "watchcow.memos"}
+	if !reflect.DeepEqual(got, want) {
+		t.Errorf("parseAppList() = %v, want %v", got, want)
+	}
+}
+
+// TestParseAppList_Empty tests output without a table
+func TestParseAppList_Empty(t *testing.T) {
+	if got := parseAppList("No apps installed\n"); len(got) != 0 {
+		t.Errorf("expected no apps, got %v", got)
+	}
+}
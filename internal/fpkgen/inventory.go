@@ -0,0 +1,158 @@
+package fpkgen
+
+import (
+	"context"
+	"log/slog"
+	"sync"
+	"time"
+)
+
+// DefaultInventoryRefresh is how often the installed-app index is re-read from appcenter-cli
+const DefaultInventoryRefresh = 10 * time.Minute
+
+// inventoryRetryDelay is how long Has keeps answering from the stale index
+// after a failed refresh before it lists again
+const inventoryRetryDelay = 30 * time.Second
+
+// AppInventory is an in-memory index of apps installed in the fnOS App Center.
+// It is filled from the installed-app list once, kept current by our own
+// install/uninstall results, and re-read on a slow interval or after
+// Invalidate, so existence checks are map lookups instead of process spawns.
+//
+// A list runs outside the operation worker, so installs and uninstalls can
+// finish while it runs; they are recorded and reapplied on top of its result.
+type AppInventory struct {
+	installer Installer
+
+	mu       sync.RWMutex
+	apps     map[string]bool
+	loaded   bool
+	changes  map[string]bool // Add/Remove during a list (map[appName]installed), nil when none runs
+	failedAt time.Time       // Last failed refresh, rate-limits retries from Has
+
+	refreshMu sync.Mutex // Serializes list invocations
+}
+
+// NewAppInventory creates an empty inventory backed by installer
+func NewAppInventory(installer Installer) *AppInventory {
+	return &AppInventory{
+		installer: installer,
+		apps:      make(map[string]bool),
+	}
+}
+
+// Refresh replaces the index with the current appcenter-cli list output
+func (inv *AppInventory) Refresh(ctx context.Context) error {
+	inv.refreshMu.Lock()
+	defer inv.refreshMu.Unlock()
+	return inv.refreshLocked(ctx)
+}
+
+// refreshLocked runs appcenter-cli list; callers must hold refreshMu
+func (inv *AppInventory) refreshLocked(ctx context.Context) error {
+	inv.mu.Lock()
+	inv.changes = make(map[string]bool)
+	inv.mu.Unlock()
+
+	apps, err := inv.installer.ListInstalledApps(ctx)
+
+	inv.mu.Lock()
+	defer inv.mu.Unlock()
+	changes := inv.changes
+	inv.changes = nil
+	if err != nil {
+		inv.failedAt = time.Now()
+		return err
+	}
+
+	index := make(map[string]bool, len(apps))
+	for _, name := range apps {
+		index[name] = true
+	}
+	// The list may predate our own operations that finished meanwhile
+	for name, installed := range changes {
+		if installed {
+			index[name] = true
+		} else {
+			delete(index, name)
+		}
+	}
+	inv.apps = index
+	inv.loaded = true
+
+	slog.Debug("Refreshed installed app inventory", "count", len(index))
+	return nil
+}
+
+// Has reports whether an app is installed, loading the index first if needed
+func (inv *AppInventory) Has(ctx context.Context, appName string) bool {
+	inv.mu.RLock()
+	loaded := inv.loaded
+	installed := inv.apps[appName]
+	inv.mu.RUnlock()
+	if loaded {
+		return installed
+	}
+
+	// Concurrent callers wait for a single refresh instead of each forking
+	// list, and a failing list is not retried on every call
+	inv.refreshMu.Lock()
+	inv.mu.RLock()
+	loaded = inv.loaded || time.Since(inv.failedAt) < inventoryRetryDelay
+	inv.mu.RUnlock()
+	if !loaded {
+		if err := inv.refreshLocked(ctx); err != nil {
+			slog.Debug("Failed to refresh app inventory", "error", err)
+		}
+	}
+	inv.refreshMu.Unlock()
+
+	inv.mu.RLock()
+	defer inv.mu.RUnlock()
+	return inv.apps[appName]
+}
+
+// Add records a successful install
+func (inv *AppInventory) Add(appName string) {
+	inv.mu.Lock()
+	inv.apps[appName] = true
+	if inv.changes != nil {
+		inv.changes[appName] = true
+	}
+	inv.mu.Unlock()
+}
+
+// Remove records a successful uninstall
+func (inv *AppInventory) Remove(appName string) {
+	inv.mu.Lock()
+	delete(inv.apps, appName)
+	if inv.changes != nil {
+		inv.changes[appName] = false
+	}
+	inv.mu.Unlock()
+}
+
+// Invalidate marks the index as stale, e.g. after an operation failed in a way
+// that contradicts it. The next Has re-reads appcenter-cli list.
+func (inv *AppInventory) Invalidate() {
+	inv.mu.Lock()
+	inv.loaded = false
+	inv.mu.Unlock()
+}
+
+// Run refreshes the index every interval until ctx is done
+func (inv *AppInventory) Run(ctx context.Context, interval time.Duration) {
+	ticker := time.NewTicker(interval)
+	defer ticker.Stop()
+
+	for {
+		select {
+		case <-ctx.Done():
+			return
+		case <-ticker.C:
+			if err := inv.Refresh(ctx); err != nil {
+				slog.Warn("Failed to refresh app inventory", "error", err)
+			}
+		}
+	}
+}
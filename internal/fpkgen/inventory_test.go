@@ -0,0 +1,70 @@
+package fpkgen
+
+import (
+	"context"
+	"errors"
+	"sync/atomic"
+	"testing"
+)
+
+// listInstaller is an Installer whose list returns fixed apps after running
+// during, e.g. to finish an install while the list is in flight
+type listInstaller struct {
+	Installer
+	apps   []string
+	err    error
+	during func()
+	calls  atomic.Int32
+}
+
+func (l *listInstaller) ListInstalledApps(ctx context.Context) ([]string, error) {
+	l.calls.Add(1)
+	if l.during != nil {
+		l.during()
+	}
+	return l.apps, l.err
+}
+
+// TestAppInventory_KeepsChangesDuringRefresh tests that an install or
+// uninstall finishing while list runs is not lost when its result lands
+func TestAppInventory_KeepsChangesDuringRefresh(t *testing.T) {
+	installer := &listInstaller{apps: []string{"watchcow.old"}}
+	inv := NewAppInventory(installer)
+	ctx := context.Background()
+	installer.during = func() {
+		inv.Add("watchcow.new")
+		inv.Remove("watchcow.old")
+	}
+
+	if err := inv.Refresh(ctx); err != nil {
+		t.Fatalf("Refresh failed: %v", err)
+	}
+	if !inv.Has(ctx, "watchcow.new") || inv.Has(ctx, "watchcow.old") {
+		t.Errorf("apps = %v, want the install and uninstall applied on top of the list", inv.apps)
+	}
+
+	// Without a list in flight, the next refresh takes the list as is
+	installer.during = nil
+	installer.apps = []string{"watchcow.other"}
+	inv.Refresh(ctx)
+	if inv.Has(ctx, "watchcow.new") || !inv.Has(ctx, "watchcow.other") {
+		t.Errorf("apps = %v after a plain refresh", inv.apps)
+	}
+}
+
+// TestAppInventory_RateLimitsFailedRefresh tests that Has does not list on
+// every call while appcenter-cli list keeps failing
+func TestAppInventory_RateLimitsFailedRefresh(t *testing.T) {
+	installer := &listInstaller{err: errors.New("list failed")}
+	inv := NewAppInventory(installer)
+	ctx := context.Background()
+
+	for n := 0; n < 3; n++ {
+		if inv.Has(ctx, "watchcow.a") {
+			t.Error("Has reported an app without a list")
+		}
+	}
+	if calls := installer.calls.Load(); calls != 1 {
+		t.Errorf("list ran %d times, want 1 until the retry delay passes", calls)
+	}
+}
@@ -0,0 +1,202 @@
+package fpkgen
+
+import (
+	"sort"
+	"strings"
+)
+
+// labelPrefix is the namespace of all watchcow labels
+const labelPrefix = "watchcow."
+
+// entryLabels holds the raw label values of one entry. Empty means unset:
+// an empty label value falls back to the default like a missing one.
+type entryLabels struct {
+	title      string
+	protocol   string
+	port       string
+	path       string
+	uiType     string
+	allUsers   string
+	icon       string
+	fileTypes  string
+	noDisplay  string
+	accessPerm string
+	portPerm   string
+	pathPerm   string
+}
+
+// set stores value under an entry field name; unknown fields are ignored
+func (e *entryLabels) set(field, value string) {
+	switch field {
+	case "title":
+		e.title = value
+	case "protocol":
+		e.protocol = value
+	case "service_port":
+		e.port = value
+	case "path":
+		e.path = value
+	case "ui_type":
+		e.uiType = value
+	case "all_users":
+		e.allUsers = value
+	case "icon":
+		e.icon = value
+	case "file_types":
+		e.fileTypes = value
+	case "no_display":
+		e.noDisplay = value
+	case "control.access_perm":
+		e.accessPerm = value
+	case "control.port_perm":
+		e.portPerm = value
+	case "control.path_perm":
+		e.pathPerm = value
+	}
+}
+
+// labelIndex is every watchcow.* label of a container, grouped in one sweep
+type labelIndex struct {
+	// App-level labels
+	appName     string
+	displayName string
+	version     string
+	desc        string
+	maintainer  string
+
+	// defaultEntry holds watchcow.<field>; hasDefault is set when any of the
+	// keys that declare a default entry is present (even if empty)
+	defaultEntry entryLabels
+	hasDefault   bool
+
+	// named holds watchcow.<name>.<field>, in names order (sorted)
+	named map[string]*entryLabels
+	names []string
+}
+
+// indexLabels groups the watchcow.* labels in a single pass over the map.
+// Keys are split by slicing, so no per-field strings are built.
+func indexLabels(labels map[string]string) *labelIndex {
+	idx := &labelIndex{}
+
+	for key, value := range labels {
+		if !strings.HasPrefix(key, labelPrefix) {
+			continue
+		}
+		rest := key[len(labelPrefix):]
+
+		switch rest {
+		case "appname":
+			idx.appName = value
+		case "display_name":
+			idx.displayName = value
+		case "version":
+			idx.version = value
+		case "desc":
+			idx.desc = value
+		case "maintainer":
+			idx.maintainer = value
+		case "service_port", "protocol", "path", "title", "ui_type":
+			idx.hasDefault = true
+		}
+		idx.defaultEntry.set(rest, value)
+
+		// Named entry field, e.g. "admin.service_port"
+		if name, field, ok := strings.Cut(rest, "."); ok && isEntryField(field) {
+			entry := idx.named[name]
+			if entry == nil {
+				if idx.named == nil {
+					idx.named = make(map[string]*entryLabels)
+				}
+				entry = &entryLabels{}
+				idx.named[name] = entry
+				idx.names = append(idx.names, name)
+			}
+			entry.set(field, value)
+		}
+	}
+
+	sort.Strings(idx.names)
+	return idx
+}
+
+// entry builds the Entry for one entry's labels
+// name: entry name (empty string for default entry)
+// displayName: app display name for generating default title
+// defaultIcon: fallback icon URL
+func (e *entryLabels) entry(name string, displayName string, defaultIcon string) Entry {
+	// title default logic:
+	// - default entry: use display_name
+	// - named entry: use "display_name - entry_name"
+	title := e.title
+	if title == "" {
+		if name == "" {
+			title = displayName
+		} else {
+			title = displayName + " - " + name
+		}
+	}
+
+	// Parse file types (comma-separated list)
+	var fileTypes []string
+	if e.fileTypes != "" {
+		for _, t := range strings.Split(e.fileTypes, ",") {
+			t = strings.TrimSpace(t)
+			if t != "" {
+				fileTypes = append(fileTypes, t)
+			}
+		}
+	}
+
+	// Parse control settings
+	var control *EntryControl
+	if e.accessPerm != "" || e.portPerm != "" || e.pathPerm != "" {
+		control = &EntryControl{
+			AccessPerm: e.accessPerm,
+			PortPerm:   e.portPerm,
+			PathPerm:   e.pathPerm,
+		}
+	}
+
+	return Entry{
+		Name:      name,
+		Title:     title,
+		Protocol:  orDefault(e.protocol, "http"),
+		Port:      e.port,
+		Path:      orDefault(e.path, "/"),
+		UIType:    orDefault(e.uiType, "url"),
+		AllUsers:  orDefault(e.allUsers, "true") == "true",
+		Icon:      orDefault(e.icon, defaultIcon),
+		FileTypes: fileTypes,
+		NoDisplay: e.noDisplay == "true",
+		Control:   control,
+	}
+}
+
+// entries builds the default entry (if declared) followed by the named entries in name order
+func (idx *labelIndex) entries(displayName string, defaultIcon string, defaultPort string) []Entry {
+	entries := make([]Entry, 0, len(idx.names)+1)
+
+	if idx.hasDefault {
+		entry := idx.defaultEntry.entry("", displayName, defaultIcon)
+		// Use container's first port as fallback if not specified
+		if entry.Port == "" {
+			entry.Port = defaultPort
+		}
+		entries = append(entries, entry)
+	}
+
+	for _, name := range idx.names {
+		entries = append(entries, idx.named[name].entry(name, displayName, defaultIcon))
+	}
+
+	return entries
+}
+
+// orDefault returns value, or fallback if value is empty
+func orDefault(value, fallback string) string {
+	if value != "" {
+		return value
+	}
+	return fallback
+}
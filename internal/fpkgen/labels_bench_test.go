@@ -0,0 +1,66 @@
+package fpkgen
+
+import (
+	"fmt"
+	"testing"
+
+	dockercontainer "github.com/docker/docker/api/types/container"
+)
+
+// benchInspect returns a compose-style container with three entries and ~80 labels
+func benchInspect() *dockercontainer.InspectResponse {
+	labels := map[string]string{
+		"watchcow.enable":       "true",
+		"watchcow.appname":      "watchcow.bench",
+		"watchcow.display_name": "Bench",
+		"watchcow.desc":         "Benchmark container",
+		"watchcow.service_port": "8080",
+		"watchcow.title":        "Bench",
+		"watchcow.icon":         "https://example.com/icon.png",
+	}
+	for _, name := range []string{"admin", "api"} {
+		labels["watchcow."+name+".service_port"] = "8081"
+		labels["watchcow."+name+".path"] = "/" + name
+		labels["watchcow."+name+".title"] = name
+		labels["watchcow."+name+".file_types"] = "txt, md, json"
+		labels["watchcow."+name+".control.access_perm"] = "readonly"
+	}
+	// Unrelated compose and OCI labels make up most of a real label set
+	for i := 0; i < 60; i++ {
+		labels[fmt.Sprintf("com.docker.compose.extra%d", i)] = "value"
+	}
+
+	return &dockercontainer.InspectResponse{
+		ContainerJSONBase: &dockercontainer.ContainerJSONBase{
+			ID:         "abcdef1234567890",
+			Name:       "/bench",
+			HostConfig: &dockercontainer.HostConfig{},
+		},
+		Config: &dockercontainer.Config{
+			Image:  "nginx:alpine",
+			Labels: labels,
+			Env:    []string{"PATH=/usr/bin", "TZ=UTC"},
+		},
+	}
+}
+
+// BenchmarkExtractConfig measures turning a labelled container into an AppConfig
+func BenchmarkExtractConfig(b *testing.B) {
+	g := &Generator{}
+	info := benchInspect()
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		g.extractConfig(info)
+	}
+}
+
+// BenchmarkParseEntries measures entry parsing alone
+func BenchmarkParseEntries(b *testing.B) {
+	labels := benchInspect().Config.Labels
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		parseEntries(labels, "Bench", "https://example.com/icon.png", "8080")
+	}
+}
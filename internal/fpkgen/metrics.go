@@ -0,0 +1,30 @@
+package fpkgen
+
+import (
+	"context"
+	"time"
+
+	"watchcow/internal/metrics"
+	"watchcow/internal/trace"
+)
+
+var (
+	cliDuration = metrics.NewHistogramVec("watchcow_appcenter_cli_duration_seconds",
+		"Duration of appcenter-cli invocations, by operation.", "op", metrics.SlowBuckets)
+	generatePhaseDuration = metrics.NewHistogramVec("watchcow_generate_phase_duration_seconds",
+		"Duration of package generation phases (inspect, templates, icons, hash, write).", "phase", metrics.DefBuckets)
+	iconCacheLookups = metrics.NewCounterVec("watchcow_icon_cache_lookups_total",
+		"Icon cache lookups, by result (hit, revalidated, stale, miss).", "result")
+)
+
+// StartGeneratePhase times one generation stage as both a metric and a trace
+// span; call the returned function with the stage's error when it is done.
+// The monitor uses it for stages it runs itself, such as the cached inspect.
+func StartGeneratePhase(ctx context.Context, phase string) func(error) {
+	start := time.Now()
+	_, span := trace.Start(ctx, phase)
+	return func(err error) {
+		generatePhaseDuration.Since(phase, start)
+		span.End(err)
+	}
+}
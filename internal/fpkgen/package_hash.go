@@ -0,0 +1,81 @@
+package fpkgen
+
+import (
+	"crypto/sha256"
+	"encoding/binary"
+	"encoding/hex"
+	"encoding/json"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"strings"
+)
+
+// PackageHashFile is written into app/ so the installed copy carries its own
+// hash (app/ is installed as /var/apps/<appname>/target)
+const PackageHashFile = "watchcow.hash"
+
+// packageHashPath is where PackageHashFile lives inside the package tree
+const packageHashPath = "app/" + PackageHashFile
+
+// packageHash computes a content hash over the template data and every file in
+// the package tree (relative path, mode and bytes, in WalkDir order), excluding
+// the hash file itself. The container ID is excluded so identical recreates
+// hash the same.
+func packageHash(tree *packageTree, data *TemplateData) (string, error) {
+	h := sha256.New()
+
+	stable := *data
+	stable.ContainerID = ""
+	dataJSON, err := json.Marshal(&stable)
+	if err != nil {
+		return "", fmt.Errorf("failed to encode template data: %w", err)
+	}
+	writeHashField(h, dataJSON)
+
+	for _, f := range tree.sorted() {
+		if f.path == packageHashPath {
+			continue
+		}
+		writeHashField(h, []byte(f.path))
+		binary.Write(h, binary.BigEndian, uint32(f.perm.Perm()))
+		binary.Write(h, binary.BigEndian, int64(len(f.data)))
+		h.Write(f.data)
+	}
+
+	return hex.EncodeToString(h.Sum(nil)), nil
+}
+
+// writeHashField writes a length-prefixed field so adjacent fields cannot collide
+func writeHashField(w io.Writer, b []byte) {
+	binary.Write(w, binary.BigEndian, uint64(len(b)))
+	w.Write(b)
+}
+
+// addPackageHash computes the package hash and stores it in the tree at packageHashPath
+func addPackageHash(tree *packageTree, data *TemplateData) (string, error) {
+	hash, err := packageHash(tree, data)
+	if err != nil {
+		return "", err
+	}
+	tree.add(packageHashPath, []byte(hash+"\n"), 0644)
+	return hash, nil
+}
+
+// readPackageHash returns the hash stored in dir/PackageHashFile, or "" if absent
+func readPackageHash(dir string) string {
+	data, err := os.ReadFile(filepath.Join(dir, PackageHashFile))
+	if err != nil {
+		return ""
+	}
+	return strings.TrimSpace(string(data))
+}
+
+// shortHash abbreviates a package hash for logging
+func shortHash(hash string) string {
+	if len(hash) > 12 {
+		return hash[:12]
+	}
+	return hash
+}
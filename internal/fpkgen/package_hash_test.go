@@ -0,0 +1,57 @@
+package fpkgen
+
+import (
+	"path/filepath"
+	"testing"
+)
+
+// generateTestPackage renders a package for config into a temp dir and returns its hash
+func generateTestPackage(t *testing.T, config *AppConfig) string {
+	t.Helper()
+	engine, err := NewTemplateEngine()
+	if err != nil {
+		t.Fatalf("NewTemplateEngine failed: %v", err)
+	}
+	g := &Generator{templateEngine: engine}
+
+	appDir := filepath.Join(t.TempDir(), "pkg")
+	if err := g.GenerateFromConfig(config, appDir); err != nil {
+		t.Fatalf("GenerateFromConfig failed: %v", err)
+	}
+	if stored := readPackageHash(filepath.Join(appDir, "app")); stored != config.PackageHash {
+		t.Fatalf("stored hash %q does not match returned hash %q", stored, config.PackageHash)
+	}
+	return config.PackageHash
+}
+
+func hashTestConfig(containerID, desc string) *AppConfig {
+	return &AppConfig{
+		AppName:       "watchcow.nginx",
+		Version:       "1.0.0",
+		DisplayName:   "Nginx",
+		Description:   desc,
+		ContainerID:   containerID,
+		ContainerName: "nginx",
+		Image:         "nginx:alpine",
+		Port:          "8080",
+		Entries:       []Entry{{Title: "Nginx", Port: "8080", Icon: "ftp://unused"}},
+	}
+}
+
+// TestPackageHash_StableAcrossRecreate tests that a recreated container with identical config hashes the same
+func TestPackageHash_StableAcrossRecreate(t *testing.T) {
+	first := generateTestPackage(t, hashTestConfig("aaaaaaaaaaaa", "Web server"))
+	second := generateTestPackage(t, hashTestConfig("bbbbbbbbbbbb", "Web server"))
+	if first == "" || first != second {
+		t.Errorf("expected identical hashes for recreated container, got %q and %q", first, second)
+	}
+}
+
+// TestPackageHash_LabelChangeDiffers tests that a label-only edit changes the hash
+func TestPackageHash_LabelChangeDiffers(t *testing.T) {
+	first := generateTestPackage(t, hashTestConfig("aaaaaaaaaaaa", "Web server"))
+	second := generateTestPackage(t, hashTestConfig("aaaaaaaaaaaa", "Reverse proxy"))
+	if first == second {
+		t.Error("expected description change to produce a different hash")
+	}
+}
@@ -0,0 +1,100 @@
+package fpkgen
+
+import (
+	"fmt"
+	"os"
+	"path"
+	"path/filepath"
+	"sort"
+	"strings"
+)
+
+// packageFile is one file of a package held in memory
+type packageFile struct {
+	path string // Slash-separated, relative to the package root
+	data []byte
+	perm os.FileMode
+}
+
+// packageTree is a package rendered fully in memory, so it can be hashed and
+// then written to disk in a single pass with one MkdirAll per directory
+type packageTree struct {
+	files []packageFile
+	index map[string]int // map[path]position in files
+}
+
+// packageDirs are created even if no file lands in them
+var packageDirs = []string{"app/ui/images", "cmd", "config"}
+
+// newPackageTree creates an empty tree
+func newPackageTree() *packageTree {
+	return &packageTree{index: make(map[string]int)}
+}
+
+// add stores a file, replacing any earlier file at the same path.
+// data is not copied, so identical files may share one buffer.
+func (t *packageTree) add(relPath string, data []byte, perm os.FileMode) {
+	if i, ok := t.index[relPath]; ok {
+		t.files[i] = packageFile{path: relPath, data: data, perm: perm}
+		return
+	}
+	t.index[relPath] = len(t.files)
+	t.files = append(t.files, packageFile{path: relPath, data: data, perm: perm})
+}
+
+// get returns the contents of a file, or nil if absent
+func (t *packageTree) get(relPath string) []byte {
+	if i, ok := t.index[relPath]; ok {
+		return t.files[i].data
+	}
+	return nil
+}
+
+// sorted returns the files in the order filepath.WalkDir would visit them
+// (lexical per path component, so "a/b" comes before "a-b")
+func (t *packageTree) sorted() []packageFile {
+	files := append([]packageFile(nil), t.files...)
+	sort.Slice(files, func(i, j int) bool {
+		a, b := strings.Split(files[i].path, "/"), strings.Split(files[j].path, "/")
+		for k := 0; k < len(a) && k < len(b); k++ {
+			if a[k] != b[k] {
+				return a[k] < b[k]
+			}
+		}
+		return len(a) < len(b)
+	})
+	return files
+}
+
+// writeTo writes the tree under root, which is created if missing
+func (t *packageTree) writeTo(root string) error {
+	// Only leaf directories need MkdirAll; parents are created with them
+	dirSet := make(map[string]bool)
+	for _, d := range packageDirs {
+		dirSet[d] = true
+	}
+	for _, f := range t.files {
+		dirSet[path.Dir(f.path)] = true
+	}
+	dirs := make([]string, 0, len(dirSet))
+	for d := range dirSet {
+		dirs = append(dirs, d)
+	}
+	sort.Strings(dirs)
+
+	for i, d := range dirs {
+		if i+1 < len(dirs) && strings.HasPrefix(dirs[i+1], d+"/") {
+			continue
+		}
+		if err := os.MkdirAll(filepath.Join(root, filepath.FromSlash(d)), 0755); err != nil {
+			return fmt.Errorf("failed to create directory %s: %w", d, err)
+		}
+	}
+
+	for _, f := range t.files {
+		if err := os.WriteFile(filepath.Join(root, filepath.FromSlash(f.path)), f.data, f.perm); err != nil {
+			return fmt.Errorf("failed to write %s: %w", f.path, err)
+		}
+	}
+	return nil
+}
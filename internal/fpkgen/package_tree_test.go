@@ -0,0 +1,48 @@
+package fpkgen
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+)
+
+// TestPackageTree_WriteTo tests that files, permissions and the fixed directories are written
+func TestPackageTree_WriteTo(t *testing.T) {
+	tree := newPackageTree()
+	tree.add("manifest", []byte("appname=test\n"), 0644)
+	tree.add("cmd/main", []byte("#!/bin/sh\n"), 0755)
+	tree.add("cmd/main", []byte("#!/bin/bash\n"), 0755) // Replaces the earlier file
+
+	root := filepath.Join(t.TempDir(), "pkg")
+	if err := tree.writeTo(root); err != nil {
+		t.Fatalf("writeTo failed: %v", err)
+	}
+
+	data, err := os.ReadFile(filepath.Join(root, "cmd", "main"))
+	if err != nil || string(data) != "#!/bin/bash\n" {
+		t.Errorf("unexpected cmd/main: %q, %v", data, err)
+	}
+	if info, err := os.Stat(filepath.Join(root, "cmd", "main")); err != nil || info.Mode().Perm()&0100 == 0 {
+		t.Errorf("expected cmd/main to be executable: %v", err)
+	}
+	for _, dir := range packageDirs {
+		if info, err := os.Stat(filepath.Join(root, dir)); err != nil || !info.IsDir() {
+			t.Errorf("expected directory %s: %v", dir, err)
+		}
+	}
+}
+
+// TestPackageTree_SortedMatchesWalkOrder tests the component-wise ordering used for hashing
+func TestPackageTree_SortedMatchesWalkOrder(t *testing.T) {
+	tree := newPackageTree()
+	for _, p := range []string{"a-b", "a/c", "ICON.PNG", "a/b/d"} {
+		tree.add(p, nil, 0644)
+	}
+
+	want := []string{"ICON.PNG", "a/b/d", "a/c", "a-b"}
+	for i, f := range tree.sorted() {
+		if f.path != want[i] {
+			t.Fatalf("position %d: expected %s, got %s", i, want[i], f.path)
+		}
+	}
+}
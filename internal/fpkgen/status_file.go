@@ -0,0 +1,128 @@
+package fpkgen
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+	"strconv"
+	"strings"
+	"sync"
+)
+
+// StatusDir is where watchcow publishes container run state for the
+// generated cmd/main status check. It lives on tmpfs, so nothing stale
+// survives a reboot.
+const StatusDir = "/run/watchcow/status"
+
+// statusPidFile names the running watchcow; cmd/main ignores the directory
+// unless that process is alive
+const statusPidFile = ".pid"
+
+// StatusFiles keeps one small file per container ("running" or "stopped")
+// so that fnOS status polls read a file instead of forking docker
+type StatusFiles struct {
+	dir string
+	mu  sync.Mutex // Serializes writes to the same container's file
+}
+
+// OpenStatusFiles creates dir and claims it for this process
+func OpenStatusFiles(dir string) (*StatusFiles, error) {
+	if err := os.MkdirAll(dir, 0755); err != nil {
+		return nil, fmt.Errorf("failed to create status directory: %w", err)
+	}
+	s := &StatusFiles{dir: dir}
+	if err := s.write(statusPidFile, strconv.Itoa(os.Getpid())); err != nil {
+		return nil, err
+	}
+	return s, nil
+}
+
+// Set records whether a container is running
+func (s *StatusFiles) Set(containerName string, running bool) error {
+	state := "stopped"
+	if running {
+		state = "running"
+	}
+	return s.write(containerName, state)
+}
+
+// Remove forgets a container, e.g. after it was destroyed
+func (s *StatusFiles) Remove(containerName string) error {
+	if !validStatusName(containerName) {
+		return nil
+	}
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if err := os.Remove(filepath.Join(s.dir, containerName)); err != nil && !os.IsNotExist(err) {
+		return err
+	}
+	return nil
+}
+
+// Sync replaces all container files with states (map[containerName]running).
+// Files for which keep reports true are left as they are, e.g. because they
+// were updated after states was taken (nil = replace all).
+func (s *StatusFiles) Sync(states map[string]bool, keep func(containerName string) bool) error {
+	if keep == nil {
+		keep = func(string) bool { return false }
+	}
+	entries, err := os.ReadDir(s.dir)
+	if err != nil {
+		return err
+	}
+	for _, entry := range entries {
+		if name := entry.Name(); name != statusPidFile && !strings.HasPrefix(name, ".tmp-") {
+			if _, ok := states[name]; !ok && !keep(name) {
+				s.Remove(name)
+			}
+		}
+	}
+	for name, running := range states {
+		if keep(name) {
+			continue
+		}
+		if err := s.Set(name, running); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// Close releases the directory; cmd/main falls back to docker inspect
+func (s *StatusFiles) Close() error {
+	return os.Remove(filepath.Join(s.dir, statusPidFile))
+}
+
+// write atomically replaces dir/name, so readers never see a partial state
+func (s *StatusFiles) write(name, content string) error {
+	if !validStatusName(name) {
+		return fmt.Errorf("invalid status file name %q", name)
+	}
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	tmp, err := os.CreateTemp(s.dir, ".tmp-")
+	if err != nil {
+		return err
+	}
+	_, err = tmp.WriteString(content + "\n")
+	if cerr := tmp.Close(); err == nil {
+		err = cerr
+	}
+	if err == nil {
+		err = os.Chmod(tmp.Name(), 0644)
+	}
+	if err == nil {
+		err = os.Rename(tmp.Name(), filepath.Join(s.dir, name))
+	}
+	if err != nil {
+		os.Remove(tmp.Name())
+		return fmt.Errorf("failed to write status file: %w", err)
+	}
+	return nil
+}
+
+// validStatusName rejects names that would escape the status directory
+func validStatusName(name string) bool {
+	return name != "" && name != "." && name != ".." && !strings.ContainsAny(name, "/\x00")
+}
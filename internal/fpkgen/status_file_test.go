@@ -0,0 +1,135 @@
+package fpkgen
+
+import (
+	"errors"
+	"os"
+	"os/exec"
+	"path/filepath"
+	"testing"
+)
+
+// TestStatusFiles tests writing, syncing and releasing the status directory
+func TestStatusFiles(t *testing.T) {
+	dir := filepath.Join(t.TempDir(), "status")
+	s, err := OpenStatusFiles(dir)
+	if err != nil {
+		t.Fatalf("OpenStatusFiles failed: %v", err)
+	}
+
+	read := func(name string) string {
+		data, err := os.ReadFile(filepath.Join(dir, name))
+		if err != nil {
+			return ""
+		}
+		return string(data)
+	}
+
+	s.Set("web", true)
+	s.Set("db", false)
+	if read("web") != "running\n" || read("db") != "stopped\n" {
+		t.Errorf("web=%q db=%q", read("web"), read("db"))
+	}
+	if err := s.Set("../escape", true); err == nil {
+		t.Error("expected a name with a slash to be rejected")
+	}
+
+	s.Sync(map[string]bool{"web": false, "cache": true}, nil)
+	if read("web") != "stopped\n" || read("cache") != "running\n" || read("db") != "" {
+		t.Errorf("after Sync web=%q cache=%q db=%q", read("web"), read("cache"), read("db"))
+	}
+
+	// Kept files survive a sync that would overwrite or remove them
+	s.Set("db", true)
+	keep := func(name string) bool { return name == "web" || name == "db" }
+	s.Sync(map[string]bool{"web": true, "cache": false}, keep)
+	if read("web") != "stopped\n" || read("db") != "running\n" || read("cache") != "stopped\n" {
+		t.Errorf("after keeping Sync web=%q cache=%q db=%q", read("web"), read("cache"), read("db"))
+	}
+	s.Remove("db")
+
+	s.Remove("cache")
+	if read("cache") != "" {
+		t.Error("Remove left the file")
+	}
+
+	if read(statusPidFile) == "" {
+		t.Error("pid file missing")
+	}
+	s.Close()
+	if _, err := os.Stat(filepath.Join(dir, statusPidFile)); !errors.Is(err, os.ErrNotExist) {
+		t.Error("Close should remove the pid file")
+	}
+}
+
+// TestCmdMainStatus tests the generated status check against status files
+// and its docker inspect fallback
+func TestCmdMainStatus(t *testing.T) {
+	if _, err := exec.LookPath("bash"); err != nil {
+		t.Skip("bash not available")
+	}
+	engine, err := NewTemplateEngine()
+	if err != nil {
+		t.Fatalf("NewTemplateEngine failed: %v", err)
+	}
+
+	tmp := t.TempDir()
+	statusDir := filepath.Join(tmp, "status")
+	data := NewTemplateData(&AppConfig{AppName: "watchcow.web", ContainerName: "web"})
+	data.StatusDir = statusDir
+	script := filepath.Join(tmp, "main")
+	if err := engine.RenderToFile("cmd_main.tmpl", script, data, 0755); err != nil {
+		t.Fatalf("Render failed: %v", err)
+	}
+
+	// A fake docker that reports the container as running and logs calls
+	binDir := filepath.Join(tmp, "bin")
+	calls := filepath.Join(tmp, "docker-calls")
+	os.MkdirAll(binDir, 0755)
+	os.WriteFile(filepath.Join(binDir, "docker"), []byte("#!/bin/sh\necho \"$@\" >> "+calls+"\necho true\n"), 0755)
+
+	status := func() int {
+		cmd := exec.Command("bash", script, "status")
+		cmd.Env = append(os.Environ(), "PATH="+binDir+":/usr/bin:/bin")
+		err := cmd.Run()
+		var exitErr *exec.ExitError
+		if errors.As(err, &exitErr) {
+			return exitErr.ExitCode()
+		}
+		if err != nil {
+			t.Fatalf("status failed: %v", err)
+		}
+		return 0
+	}
+
+	// No status files: ask docker about the one container
+	if code := status(); code != 0 {
+		t.Errorf("fallback status = %d, want 0", code)
+	}
+	if got, _ := os.ReadFile(calls); string(got) != "inspect -f {{.State.Running}} web\n" {
+		t.Errorf("docker calls = %q", got)
+	}
+
+	files, err := OpenStatusFiles(statusDir)
+	if err != nil {
+		t.Fatal(err)
+	}
+	os.Remove(calls)
+	files.Set("web", false)
+	if code := status(); code != 3 {
+		t.Errorf("stopped status = %d, want 3", code)
+	}
+	files.Set("web", true)
+	if code := status(); code != 0 {
+		t.Errorf("running status = %d, want 0", code)
+	}
+	if _, err := os.Stat(calls); err == nil {
+		t.Error("status files present but docker was called")
+	}
+
+	// A dead watchcow's files are ignored
+	files.Set("web", false)
+	files.Close()
+	if code := status(); code != 0 {
+		t.Errorf("status after Close = %d, want docker's answer 0", code)
+	}
+}
@@ -5,8 +5,11 @@ import (
 	"embed"
 	"encoding/json"
 	"fmt"
+	"io"
 	"os"
 	"path/filepath"
+	"strings"
+	"sync"
 	"text/template"
 )
 
@@ -52,19 +55,50 @@ func NewTemplateEngine() (*TemplateEngine, error) {
 	return engine, nil
 }
 
-// Render renders a template with the given data
-func (e *TemplateEngine) Render(templateName string, data interface{}) ([]byte, error) {
+// renderBufPool recycles render buffers across templates and packages
+var renderBufPool = sync.Pool{
+	New: func() any { return new(bytes.Buffer) },
+}
+
+// maxPooledBufSize keeps unusually large buffers from being pinned by the pool
+const maxPooledBufSize = 64 << 10
+
+func getRenderBuf() *bytes.Buffer {
+	buf := renderBufPool.Get().(*bytes.Buffer)
+	buf.Reset()
+	return buf
+}
+
+func putRenderBuf(buf *bytes.Buffer) {
+	if buf.Cap() <= maxPooledBufSize {
+		renderBufPool.Put(buf)
+	}
+}
+
+// RenderTo renders a template with the given data directly into w
+func (e *TemplateEngine) RenderTo(w io.Writer, templateName string, data interface{}) error {
 	tmpl, ok := e.templates[templateName]
 	if !ok {
-		return nil, fmt.Errorf("template not found: %s", templateName)
+		return fmt.Errorf("template not found: %s", templateName)
 	}
 
-	var buf bytes.Buffer
-	if err := tmpl.Execute(&buf, data); err != nil {
-		return nil, fmt.Errorf("failed to execute template %s: %w", templateName, err)
+	if err := tmpl.Execute(w, data); err != nil {
+		return fmt.Errorf("failed to execute template %s: %w", templateName, err)
+	}
+	return nil
+}
+
+// Render renders a template with the given data
+// The result is an exact-size copy; the render buffer itself is pooled.
+func (e *TemplateEngine) Render(templateName string, data interface{}) ([]byte, error) {
+	buf := getRenderBuf()
+	defer putRenderBuf(buf)
+
+	if err := e.RenderTo(buf, templateName, data); err != nil {
+		return nil, err
 	}
 
-	return buf.Bytes(), nil
+	return bytes.Clone(buf.Bytes()), nil
 }
 
 // RenderToFile renders a template and writes to file
@@ -121,7 +155,7 @@ type UIConfig struct {
 // GenerateUIConfigJSON generates the UI config JSON content
 func GenerateUIConfigJSON(data *TemplateData) ([]byte, error) {
 	config := &UIConfig{
-		URL: make(map[string]*UIConfigEntry),
+		URL: make(map[string]*UIConfigEntry, len(data.Entries)),
 	}
 
 	for _, entry := range data.Entries {
@@ -148,7 +182,16 @@ func GenerateUIConfigJSON(data *TemplateData) ([]byte, error) {
 		}
 	}
 
-	return json.MarshalIndent(config, "", "    ")
+	// Same output as json.MarshalIndent, encoded into a pooled buffer
+	buf := getRenderBuf()
+	defer putRenderBuf(buf)
+
+	enc := json.NewEncoder(buf)
+	enc.SetIndent("", "    ")
+	if err := enc.Encode(config); err != nil {
+		return nil, err
+	}
+	return bytes.Clone(bytes.TrimSuffix(buf.Bytes(), []byte("\n"))), nil
 }
 
 // EntryControlData holds permission control data for template rendering
@@ -207,6 +250,7 @@ type TemplateData struct {
 	// Other
 	RestartPolicy string
 	Icon          string
+	StatusDir     string // Where watchcow publishes container run state for cmd/main
 }
 
 // NewTemplateData creates TemplateData from AppConfig
@@ -229,6 +273,7 @@ func NewTemplateData(config *AppConfig) *TemplateData {
 		Environment:   config.Environment,
 		RestartPolicy: config.RestartPolicy,
 		Icon:          config.Icon,
+		StatusDir:     StatusDir,
 	}
 
 	// Set defaults
@@ -318,27 +363,6 @@ func NewTemplateData(config *AppConfig) *TemplateData {
 
 // escapeForTemplate escapes special characters for template output
 func escapeForTemplate(s string) string {
-	// For manifest, replace newlines
-	s = replaceAll(s, "\n", " ")
-	return s
-}
-
-func replaceAll(s, old, new string) string {
-	for {
-		idx := indexOf(s, old)
-		if idx < 0 {
-			break
-		}
-		s = s[:idx] + new + s[idx+len(old):]
-	}
-	return s
-}
-
-func indexOf(s, substr string) int {
-	for i := 0; i <= len(s)-len(substr); i++ {
-		if s[i:i+len(substr)] == substr {
-			return i
-		}
-	}
-	return -1
+	// For manifest, replace newlines (single pass, no copy if there are none)
+	return strings.ReplaceAll(s, "\n", " ")
 }
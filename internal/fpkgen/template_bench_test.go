@@ -0,0 +1,117 @@
+package fpkgen
+
+import (
+	"image/color"
+	"io"
+	"log/slog"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+)
+
+// benchConfig is a multi-entry app similar to a typical compose service
+func benchConfig(iconSource string) *AppConfig {
+	return &AppConfig{
+		AppName:       "watchcow.bench",
+		Version:       "1.0.0",
+		DisplayName:   "Bench",
+		Description:   "Line one\nLine two\nLine three",
+		ContainerID:   "abcdef123456",
+		ContainerName: "bench",
+		Image:         "nginx:alpine",
+		Port:          "8080",
+		Environment:   []string{"TZ=Asia/Shanghai", "PUID=1000", "PGID=1000"},
+		Volumes:       []VolumeMapping{{Source: "/vol1/bench", Destination: "/data", Type: "bind"}},
+		Entries: []Entry{
+			{Title: "Bench", Port: "8080", Icon: iconSource},
+			{Name: "admin", Title: "Admin", Port: "8080", Path: "/admin", Icon: iconSource},
+			{Name: "api", Title: "API", Port: "8081", Path: "/api", Icon: iconSource, NoDisplay: true},
+		},
+	}
+}
+
+// silenceLogs discards slog output for the duration of a benchmark
+func silenceLogs(b *testing.B) {
+	prev := slog.Default()
+	slog.SetDefault(slog.New(slog.NewTextHandler(io.Discard, nil)))
+	b.Cleanup(func() { slog.SetDefault(prev) })
+}
+
+// BenchmarkGenerateFromConfig measures generating a full package with warm icon cache
+func BenchmarkGenerateFromConfig(b *testing.B) {
+	silenceLogs(b)
+	dir := b.TempDir()
+	iconPath := filepath.Join(dir, "icon.png")
+	if err := os.WriteFile(iconPath, encodeTestPNG(b, 256, color.RGBA{R: 255, A: 255}), 0644); err != nil {
+		b.Fatalf("Failed to write icon: %v", err)
+	}
+	cache, err := NewIconCache(filepath.Join(dir, "cache"), DefaultIconCacheTTL)
+	if err != nil {
+		b.Fatalf("NewIconCache failed: %v", err)
+	}
+	engine, err := NewTemplateEngine()
+	if err != nil {
+		b.Fatalf("NewTemplateEngine failed: %v", err)
+	}
+	g := &Generator{templateEngine: engine, iconCache: cache, iconLimits: DefaultIconLimits}
+
+	appDir := filepath.Join(dir, "pkg")
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if err := g.GenerateFromConfig(benchConfig("file://"+iconPath), appDir); err != nil {
+			b.Fatalf("GenerateFromConfig failed: %v", err)
+		}
+	}
+}
+
+// BenchmarkRenderTemplates measures rendering all templates and the UI config for one package
+func BenchmarkRenderTemplates(b *testing.B) {
+	engine, err := NewTemplateEngine()
+	if err != nil {
+		b.Fatalf("NewTemplateEngine failed: %v", err)
+	}
+	g := &Generator{templateEngine: engine}
+	data := NewTemplateData(benchConfig(""))
+
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if err := g.generateFromTemplates(newPackageTree(), data); err != nil {
+			b.Fatalf("generateFromTemplates failed: %v", err)
+		}
+	}
+}
+
+// BenchmarkEscapeForTemplate measures escaping a long multi-line description
+func BenchmarkEscapeForTemplate(b *testing.B) {
+	desc := strings.Repeat("A line of description text\n", 200)
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		escapeForTemplate(desc)
+	}
+}
+
+// BenchmarkNewTemplateData measures building the template data for one package
+func BenchmarkNewTemplateData(b *testing.B) {
+	config := benchConfig("")
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		NewTemplateData(config)
+	}
+}
+
+// BenchmarkGenerateUIConfigJSON measures encoding the desktop UI config
+func BenchmarkGenerateUIConfigJSON(b *testing.B) {
+	data := NewTemplateData(benchConfig(""))
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if _, err := GenerateUIConfigJSON(data); err != nil {
+			b.Fatalf("GenerateUIConfigJSON failed: %v", err)
+		}
+	}
+}
@@ -15,7 +15,7 @@ func TestLoadTestData_PNG(t *testing.T) {
 		t.Skip("testdata/test.png not found, run 'go run testdata/generate_testdata.go' to create")
 	}
 
-	img, err := loadLocalIcon(path)
+	img, err := loadLocalIcon(path, DefaultIconLimits)
 	if err != nil {
 		t.Fatalf("Failed to load PNG: %v", err)
 	}
@@ -32,7 +32,7 @@ func TestLoadTestData_JPEG(t *testing.T) {
 		t.Skip("testdata/test.jpg not found, run 'go run testdata/generate_testdata.go' to create")
 	}
 
-	img, err := loadLocalIcon(path)
+	img, err := loadLocalIcon(path, DefaultIconLimits)
 	if err != nil {
 		t.Fatalf("Failed to load JPEG: %v", err)
 	}
@@ -49,7 +49,7 @@ func TestLoadTestData_BMP(t *testing.T) {
 		t.Skip("testdata/test.bmp not found, run 'go run testdata/generate_testdata.go' to create")
 	}
 
-	img, err := loadLocalIcon(path)
+	img, err := loadLocalIcon(path, DefaultIconLimits)
 	if err != nil {
 		t.Fatalf("Failed to load BMP: %v", err)
 	}
@@ -66,7 +66,7 @@ func TestLoadTestData_WebP(t *testing.T) {
 		t.Skip("testdata/test.webp not found, run 'go run testdata/generate_testdata.go' to create")
 	}
 
-	img, err := loadLocalIcon(path)
+	img, err := loadLocalIcon(path, DefaultIconLimits)
 	if err != nil {
 		t.Fatalf("Failed to load WebP: %v", err)
 	}
@@ -84,7 +84,7 @@ func TestLoadTestData_ICO(t *testing.T) {
 		t.Skip("testdata/test.ico not found, run 'go run testdata/generate_testdata.go' to create")
 	}
 
-	img, err := loadLocalIcon(path)
+	img, err := loadLocalIcon(path, DefaultIconLimits)
 	if err != nil {
 		t.Fatalf("Failed to load ICO: %v", err)
 	}
@@ -101,7 +101,7 @@ func TestLoadTestData_ICOMulti(t *testing.T) {
 		t.Skip("testdata/test_multi.ico not found, run 'go run testdata/generate_testdata.go' to create")
 	}
 
-	img, err := loadLocalIcon(path)
+	img, err := loadLocalIcon(path, DefaultIconLimits)
 	if err != nil {
 		t.Fatalf("Failed to load multi-resolution ICO: %v", err)
 	}
@@ -119,7 +119,7 @@ func TestLoadTestData_Invalid(t *testing.T) {
 		t.Skip("testdata/invalid.bin not found, run 'go run testdata/generate_testdata.go' to create")
 	}
 
-	_, err := loadLocalIcon(path)
+	_, err := loadLocalIcon(path, DefaultIconLimits)
 	if err == nil {
 		t.Error("Expected error for invalid file, got nil")
 	}
@@ -58,6 +58,9 @@ type AppConfig struct {
 
 	// Labels (original watchcow labels)
 	Labels map[string]string
+
+	// PackageHash is the content hash of the generated package (set by the generator)
+	PackageHash string
 }
 
 // VolumeMapping represents a container volume mount
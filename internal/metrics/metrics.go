@@ -0,0 +1,251 @@
+// Package metrics is a minimal registry of counters, gauges and histograms
+// exposed in the Prometheus text format, so the daemon needs no client library
+package metrics
+
+import (
+	"bufio"
+	"fmt"
+	"io"
+	"math"
+	"net/http"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// DefBuckets are latency buckets in seconds for fast calls (Docker API, rendering)
+var DefBuckets = []float64{.001, .005, .01, .025, .05, .1, .25, .5, 1, 2.5, 5, 10}
+
+// SlowBuckets are latency buckets in seconds for slow work (appcenter-cli, queue waits)
+var SlowBuckets = []float64{.1, .5, 1, 2.5, 5, 10, 30, 60, 120, 300, 600}
+
+// collector is one metric family
+type collector interface {
+	metricName() string
+	write(w *bufio.Writer)
+}
+
+// Registry holds metric families in registration order
+type Registry struct {
+	mu         sync.Mutex
+	collectors []collector
+}
+
+// Default is the registry the New* constructors register with
+var Default = &Registry{}
+
+func (r *Registry) register(c collector) {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	r.collectors = append(r.collectors, c)
+}
+
+// WriteText writes every family in the Prometheus text format, sorted by name
+func (r *Registry) WriteText(w io.Writer) error {
+	r.mu.Lock()
+	collectors := append([]collector(nil), r.collectors...)
+	r.mu.Unlock()
+	sort.Slice(collectors, func(i, j int) bool {
+		return collectors[i].metricName() < collectors[j].metricName()
+	})
+
+	bw := bufio.NewWriter(w)
+	for _, c := range collectors {
+		c.write(bw)
+	}
+	return bw.Flush()
+}
+
+// Handler serves the Default registry
+func Handler() http.Handler {
+	return http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		w.Header().Set("Content-Type", "text/plain; version=0.0.4; charset=utf-8")
+		Default.WriteText(w)
+	})
+}
+
+// writeHeader writes the HELP and TYPE lines of a family
+func writeHeader(w *bufio.Writer, name, help, typ string) {
+	fmt.Fprintf(w, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, typ)
+}
+
+// labelPair formats {label="value"}, or nothing for an unlabelled metric
+func labelPair(label, value string) string {
+	if label == "" {
+		return ""
+	}
+	return "{" + label + `="` + escapeLabel(value) + `"}`
+}
+
+var labelEscaper = strings.NewReplacer(`\`, `\\`, `"`, `\"`, "\n", `\n`)
+
+func escapeLabel(value string) string {
+	return labelEscaper.Replace(value)
+}
+
+func formatFloat(v float64) string {
+	switch {
+	case math.IsInf(v, 1):
+		return "+Inf"
+	case math.IsInf(v, -1):
+		return "-Inf"
+	}
+	return strconv.FormatFloat(v, 'g', -1, 64)
+}
+
+// sortedKeys returns the label values of a series map in order
+func sortedKeys[V any](m map[string]V) []string {
+	keys := make([]string, 0, len(m))
+	for k := range m {
+		keys = append(keys, k)
+	}
+	sort.Strings(keys)
+	return keys
+}
+
+// CounterVec is a monotonically increasing count per label value
+type CounterVec struct {
+	name, help, label string
+
+	mu     sync.RWMutex
+	series map[string]*atomic.Uint64
+}
+
+// NewCounterVec registers a counter family partitioned by one label
+func NewCounterVec(name, help, label string) *CounterVec {
+	c := &CounterVec{name: name, help: help, label: label, series: make(map[string]*atomic.Uint64)}
+	Default.register(c)
+	return c
+}
+
+// Inc adds one to the series for value
+func (c *CounterVec) Inc(value string) {
+	c.Add(value, 1)
+}
+
+// Add adds n to the series for value
+func (c *CounterVec) Add(value string, n uint64) {
+	c.mu.RLock()
+	v := c.series[value]
+	c.mu.RUnlock()
+	if v == nil {
+		c.mu.Lock()
+		if v = c.series[value]; v == nil {
+			v = new(atomic.Uint64)
+			c.series[value] = v
+		}
+		c.mu.Unlock()
+	}
+	v.Add(n)
+}
+
+func (c *CounterVec) metricName() string { return c.name }
+
+func (c *CounterVec) write(w *bufio.Writer) {
+	writeHeader(w, c.name, c.help, "counter")
+	c.mu.RLock()
+	defer c.mu.RUnlock()
+	for _, value := range sortedKeys(c.series) {
+		fmt.Fprintf(w, "%s%s %d\n", c.name, labelPair(c.label, value), c.series[value].Load())
+	}
+}
+
+// Gauge is a single value that can go up and down
+type Gauge struct {
+	name, help string
+	bits       atomic.Uint64
+}
+
+// NewGauge registers an unlabelled gauge
+func NewGauge(name, help string) *Gauge {
+	g := &Gauge{name: name, help: help}
+	Default.register(g)
+	return g
+}
+
+// Set replaces the gauge value
+func (g *Gauge) Set(v float64) {
+	g.bits.Store(math.Float64bits(v))
+}
+
+// Value returns the current gauge value
+func (g *Gauge) Value() float64 {
+	return math.Float64frombits(g.bits.Load())
+}
+
+func (g *Gauge) metricName() string { return g.name }
+
+func (g *Gauge) write(w *bufio.Writer) {
+	writeHeader(w, g.name, g.help, "gauge")
+	fmt.Fprintf(w, "%s %s\n", g.name, formatFloat(g.Value()))
+}
+
+// HistogramVec is a distribution of observations per label value
+type HistogramVec struct {
+	name, help, label string
+	buckets           []float64 // Upper bounds, ascending
+
+	mu     sync.Mutex
+	series map[string]*histogram
+}
+
+type histogram struct {
+	counts []uint64 // Per bucket, not cumulative; last is +Inf
+	sum    float64
+	count  uint64
+}
+
+// NewHistogramVec registers a histogram family partitioned by one label
+func NewHistogramVec(name, help, label string, buckets []float64) *HistogramVec {
+	h := &HistogramVec{name: name, help: help, label: label, buckets: buckets, series: make(map[string]*histogram)}
+	Default.register(h)
+	return h
+}
+
+// Observe records one value for the series
+func (h *HistogramVec) Observe(value string, v float64) {
+	i := sort.SearchFloat64s(h.buckets, v) // First bound >= v, or len for +Inf
+
+	h.mu.Lock()
+	defer h.mu.Unlock()
+	s := h.series[value]
+	if s == nil {
+		s = &histogram{counts: make([]uint64, len(h.buckets)+1)}
+		h.series[value] = s
+	}
+	s.counts[i]++
+	s.sum += v
+	s.count++
+}
+
+// Since records the seconds elapsed since start, e.g. defer h.Since("x", time.Now())
+func (h *HistogramVec) Since(value string, start time.Time) {
+	h.Observe(value, time.Since(start).Seconds())
+}
+
+func (h *HistogramVec) metricName() string { return h.name }
+
+func (h *HistogramVec) write(w *bufio.Writer) {
+	writeHeader(w, h.name, h.help, "histogram")
+	h.mu.Lock()
+	defer h.mu.Unlock()
+
+	for _, value := range sortedKeys(h.series) {
+		s := h.series[value]
+		prefix := ""
+		if h.label != "" {
+			prefix = h.label + `="` + escapeLabel(value) + `",`
+		}
+		var cumulative uint64
+		for i, bound := range h.buckets {
+			cumulative += s.counts[i]
+			fmt.Fprintf(w, "%s_bucket{%sle=\"%s\"} %d\n", h.name, prefix, formatFloat(bound), cumulative)
+		}
+		fmt.Fprintf(w, "%s_bucket{%sle=\"+Inf\"} %d\n", h.name, prefix, s.count)
+		fmt.Fprintf(w, "%s_sum%s %s\n", h.name, labelPair(h.label, value), formatFloat(s.sum))
+		fmt.Fprintf(w, "%s_count%s %d\n", h.name, labelPair(h.label, value), s.count)
+	}
+}
@@ -0,0 +1,60 @@
+package metrics
+
+import (
+	"strings"
+	"testing"
+)
+
+func TestWriteText(t *testing.T) {
+	events := NewCounterVec("test_events_total", "Events seen.", "action")
+	depth := NewGauge("test_queue_depth", "Queued operations.")
+	latency := NewHistogramVec("test_latency_seconds", "Call latency.", "call", []float64{0.1, 1})
+
+	events.Inc("start")
+	events.Inc("start")
+	events.Add(`di"e`, 3)
+	depth.Set(4)
+	latency.Observe("inspect", 0.05)
+	latency.Observe("inspect", 0.5)
+	latency.Observe("inspect", 2)
+
+	var sb strings.Builder
+	if err := Default.WriteText(&sb); err != nil {
+		t.Fatalf("WriteText failed: %v", err)
+	}
+	out := sb.String()
+
+	for _, want := range []string{
+		"# TYPE test_events_total counter\n",
+		`test_events_total{action="di\"e"} 3` + "\n",
+		`test_events_total{action="start"} 2` + "\n",
+		"# TYPE test_queue_depth gauge\ntest_queue_depth 4\n",
+		"# TYPE test_latency_seconds histogram\n",
+		`test_latency_seconds_bucket{call="inspect",le="0.1"} 1` + "\n",
+		`test_latency_seconds_bucket{call="inspect",le="1"} 2` + "\n",
+		`test_latency_seconds_bucket{call="inspect",le="+Inf"} 3` + "\n",
+		`test_latency_seconds_sum{call="inspect"} 2.55` + "\n",
+		`test_latency_seconds_count{call="inspect"} 3` + "\n",
+	} {
+		if !strings.Contains(out, want) {
+			t.Errorf("Output missing %q:\n%s", want, out)
+		}
+	}
+
+	// Families are sorted by name
+	if strings.Index(out, "test_events_total") > strings.Index(out, "test_latency_seconds") ||
+		strings.Index(out, "test_latency_seconds") > strings.Index(out, "test_queue_depth") {
+		t.Errorf("Families not sorted by name:\n%s", out)
+	}
+}
+
+func TestHistogramBucketBoundary(t *testing.T) {
+	h := &HistogramVec{name: "b", buckets: []float64{1, 2}, series: make(map[string]*histogram)}
+	h.Observe("", 1) // le is inclusive
+	h.Observe("", 3)
+
+	s := h.series[""]
+	if s.counts[0] != 1 || s.counts[1] != 0 || s.counts[2] != 1 {
+		t.Errorf("counts = %v, want [1 0 1]", s.counts)
+	}
+}
@@ -0,0 +1,176 @@
+// Package trace correlates the work done for one Docker event across the
+// monitor, the generator and appcenter-cli. Spans travel in a context.Context;
+// finished spans are logged, and a root span logs every phase it spent time in.
+package trace
+
+import (
+	"context"
+	"crypto/rand"
+	"encoding/hex"
+	"log/slog"
+	"os"
+	"sync"
+	"time"
+)
+
+// EnvVar carries the trace ID into child processes
+const EnvVar = "WATCHCOW_TRACE_ID"
+
+type ctxKey struct{}
+
+// Span is one timed stage of a trace. All methods are safe on a nil Span.
+type Span struct {
+	name    string
+	traceID string
+	root    *Span
+	start   time.Time
+	args    []any // Extra attributes logged when the span ends
+
+	// Root only: accumulated durations of descendant spans, in first-seen order
+	mu     sync.Mutex
+	phases []phase
+}
+
+type phase struct {
+	name string
+	d    time.Duration
+}
+
+// Start begins a span as a child of the span in ctx, or as the root of a new
+// trace if there is none. args are slog key/value pairs logged with the span.
+func Start(ctx context.Context, name string, args ...any) (context.Context, *Span) {
+	s := &Span{name: name, start: time.Now(), args: args}
+	if parent := FromContext(ctx); parent != nil {
+		s.traceID = parent.traceID
+		s.root = parent.root
+	} else {
+		s.traceID = newID()
+		s.root = s
+	}
+	return context.WithValue(ctx, ctxKey{}, s), s
+}
+
+// FromContext returns the current span, or nil
+func FromContext(ctx context.Context) *Span {
+	s, _ := ctx.Value(ctxKey{}).(*Span)
+	return s
+}
+
+// ContextWithSpan returns ctx carrying s, for continuing a trace in another
+// goroutine (e.g. a queued operation picked up by a worker)
+func ContextWithSpan(ctx context.Context, s *Span) context.Context {
+	if s == nil {
+		return ctx
+	}
+	return context.WithValue(ctx, ctxKey{}, s)
+}
+
+// ID returns the trace ID in ctx, or ""
+func ID(ctx context.Context) string {
+	return FromContext(ctx).TraceID()
+}
+
+// TraceID returns the ID of the trace the span belongs to
+func (s *Span) TraceID() string {
+	if s == nil {
+		return ""
+	}
+	return s.traceID
+}
+
+// Record adds a phase measured outside a span (e.g. time spent queued)
+func (s *Span) Record(name string, d time.Duration) {
+	if s == nil {
+		return
+	}
+	s.root.addPhase(name, d)
+}
+
+// End finishes the span. Child spans are logged at debug level; a root span
+// logs its phase breakdown at info level if any stage ran under it.
+func (s *Span) End(err error) {
+	if s == nil {
+		return
+	}
+	d := time.Since(s.start)
+
+	attrs := append([]any{"trace_id", s.traceID, "span", s.name, "duration", d.Round(time.Microsecond)}, s.args...)
+	if err != nil {
+		attrs = append(attrs, "error", err)
+	}
+
+	if s.root != s {
+		s.root.addPhase(s.name, d)
+		slog.Debug("Span finished", attrs...)
+		return
+	}
+
+	s.mu.Lock()
+	phases := make([]any, 0, len(s.phases))
+	for _, p := range s.phases {
+		phases = append(phases, slog.Duration(p.name, p.d.Round(time.Microsecond)))
+	}
+	s.mu.Unlock()
+
+	if len(phases) == 0 {
+		slog.Debug("Trace finished", attrs...)
+		return
+	}
+	slog.Info("Trace finished", append(attrs, slog.Group("phases", phases...))...)
+}
+
+func (s *Span) addPhase(name string, d time.Duration) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	for i := range s.phases {
+		if s.phases[i].name == name {
+			s.phases[i].d += d
+			return
+		}
+	}
+	s.phases = append(s.phases, phase{name: name, d: d})
+}
+
+// Environ returns the process environment plus the trace ID in ctx, for exec.Cmd.Env
+func Environ(ctx context.Context) []string {
+	env := os.Environ()
+	if id := ID(ctx); id != "" {
+		env = append(env, EnvVar+"="+id)
+	}
+	return env
+}
+
+// newID returns a random 64-bit hex ID
+func newID() string {
+	var b [8]byte
+	rand.Read(b[:])
+	return hex.EncodeToString(b[:])
+}
+
+// Handler adds the trace_id of the record's context to every log record
+type Handler struct {
+	slog.Handler
+}
+
+// NewHandler wraps h so *Context logging calls carry the current trace ID
+func NewHandler(h slog.Handler) *Handler {
+	return &Handler{Handler: h}
+}
+
+// Handle implements slog.Handler
+func (h *Handler) Handle(ctx context.Context, r slog.Record) error {
+	if id := ID(ctx); id != "" {
+		r.AddAttrs(slog.String("trace_id", id))
+	}
+	return h.Handler.Handle(ctx, r)
+}
+
+// WithAttrs implements slog.Handler
+func (h *Handler) WithAttrs(attrs []slog.Attr) slog.Handler {
+	return &Handler{Handler: h.Handler.WithAttrs(attrs)}
+}
+
+// WithGroup implements slog.Handler
+func (h *Handler) WithGroup(name string) slog.Handler {
+	return &Handler{Handler: h.Handler.WithGroup(name)}
+}
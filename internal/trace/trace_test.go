@@ -0,0 +1,119 @@
+package trace
+
+import (
+	"bytes"
+	"context"
+	"errors"
+	"log/slog"
+	"strings"
+	"testing"
+	"time"
+)
+
+// captureLogs routes slog output through Handler into a buffer for the test
+func captureLogs(t *testing.T) *bytes.Buffer {
+	t.Helper()
+	var buf bytes.Buffer
+	prev := slog.Default()
+	slog.SetDefault(slog.New(NewHandler(slog.NewTextHandler(&buf, &slog.HandlerOptions{Level: slog.LevelDebug}))))
+	t.Cleanup(func() { slog.SetDefault(prev) })
+	return &buf
+}
+
+func TestSpanInheritsTrace(t *testing.T) {
+	ctx, root := Start(context.Background(), "root")
+	childCtx, child := Start(ctx, "child")
+
+	if root.TraceID() == "" || child.TraceID() != root.TraceID() {
+		t.Fatalf("child trace %q, want root trace %q", child.TraceID(), root.TraceID())
+	}
+	if ID(childCtx) != root.TraceID() {
+		t.Errorf("ID(ctx) = %q, want %q", ID(childCtx), root.TraceID())
+	}
+
+	_, other := Start(context.Background(), "other")
+	if other.TraceID() == root.TraceID() {
+		t.Error("Unrelated root span reused trace ID")
+	}
+}
+
+func TestRootLogsPhases(t *testing.T) {
+	buf := captureLogs(t)
+
+	ctx, root := Start(context.Background(), "docker_event")
+	_, a := Start(ctx, "generate")
+	a.End(nil)
+	_, b := Start(ctx, "install")
+	b.End(errors.New("boom"))
+	root.Record("queue_wait", 2*time.Second)
+	_, c := Start(ctx, "install")
+	c.End(nil)
+	root.End(nil)
+
+	out := buf.String()
+	if !strings.Contains(out, `level=DEBUG msg="Span finished" trace_id=`+root.TraceID()+" span=install") {
+		t.Errorf("Missing child span log:\n%s", out)
+	}
+	if !strings.Contains(out, "error=boom") {
+		t.Errorf("Missing span error:\n%s", out)
+	}
+
+	var summary string
+	for _, line := range strings.Split(out, "\n") {
+		if strings.Contains(line, `msg="Trace finished"`) {
+			summary = line
+		}
+	}
+	if !strings.Contains(summary, "level=INFO") || !strings.Contains(summary, "phases.queue_wait=2s") {
+		t.Fatalf("Unexpected summary: %q", summary)
+	}
+	// Repeated phases are merged and keep first-seen order
+	if strings.Count(summary, "phases.install=") != 1 ||
+		strings.Index(summary, "phases.generate=") > strings.Index(summary, "phases.install=") {
+		t.Errorf("Phases not merged in order: %q", summary)
+	}
+}
+
+func TestRootWithoutPhasesLogsAtDebug(t *testing.T) {
+	buf := captureLogs(t)
+	_, root := Start(context.Background(), "docker_event")
+	root.End(nil)
+	if !strings.Contains(buf.String(), `level=DEBUG msg="Trace finished"`) {
+		t.Errorf("Expected debug summary:\n%s", buf.String())
+	}
+}
+
+func TestHandlerAddsTraceID(t *testing.T) {
+	buf := captureLogs(t)
+	ctx, span := Start(context.Background(), "root")
+	slog.InfoContext(ctx, "hello")
+	slog.Info("untraced")
+
+	out := buf.String()
+	if !strings.Contains(out, "msg=hello trace_id="+span.TraceID()) {
+		t.Errorf("Traced record missing trace_id:\n%s", out)
+	}
+	if strings.Contains(out, "msg=untraced trace_id") {
+		t.Errorf("Untraced record got a trace_id:\n%s", out)
+	}
+}
+
+func TestNilSpan(t *testing.T) {
+	var s *Span
+	s.Record("x", time.Second)
+	s.End(nil)
+	if s.TraceID() != "" || ID(context.Background()) != "" {
+		t.Error("nil span should have no trace ID")
+	}
+	if ContextWithSpan(context.Background(), nil) != context.Background() {
+		t.Error("ContextWithSpan(nil) should return ctx unchanged")
+	}
+}
+
+func TestEnviron(t *testing.T) {
+	ctx, span := Start(context.Background(), "root")
+	env := Environ(ctx)
+	if env[len(env)-1] != EnvVar+"="+span.TraceID() {
+		t.Errorf("Environ last entry = %q", env[len(env)-1])
+	}
+}